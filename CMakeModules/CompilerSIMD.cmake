@@ -105,6 +105,23 @@ __m128 Y = _mm_movehdup_ps(X);
 SET(CMAKE_REQUIRED_FLAGS "")
 ENDMACRO(CHECK_SSE3)
 
+MACRO(CHECK_PCLMUL)
+IF(CMAKE_COMPILER_IS_GNUCC)
+  SET(PCLMUL_FLAGS "-mssse3 -mpclmul")
+ENDIF(CMAKE_COMPILER_IS_GNUCC)
+
+SET(CMAKE_REQUIRED_FLAGS "${SSE2_FLAGS} ${PCLMUL_FLAGS}")
+CHECK_C_SOURCE_COMPILES(
+"#include <tmmintrin.h>
+#include <wmmintrin.h>
+int main() {
+__m128i X = _mm_setzero_si128();
+__m128i Y = _mm_clmulepi64_si128(_mm_shuffle_epi8(X, X), X, 0x11);
+}
+" HAVE_PCLMUL)
+SET(CMAKE_REQUIRED_FLAGS "")
+ENDMACRO(CHECK_PCLMUL)
+
 MACRO(CHECK_ALTIVEC)
 IF(CMAKE_COMPILER_IS_GNUCC)
   SET(ALTIVEC_FLAGS "-maltivec")
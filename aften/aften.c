@@ -78,24 +78,25 @@ print_simd_in_use(FILE *out, AftenSimdInstructions *simd_instructions)
         fprintf(out, " SSE-MMX");
     if (simd_instructions->altivec)
         fprintf(out, " Altivec");
+    if (simd_instructions->pclmul)
+        fprintf(out, " PCLMUL");
     fprintf(out, "\n");
 }
 
 int
 main(int argc, char **argv)
 {
-    void (*aften_remap)(void *samples, int n, int ch,
-                        A52SampleFormat fmt, int acmod) = NULL;
     uint8_t *frame = NULL;
     FLOAT *fwav = NULL;
-    int nr, fs, err;
+    FLOAT *fchan[A52_NUM_SPEAKERS];
+    int nr, fs, err, planar;
     FILE *ifp[A52_NUM_SPEAKERS];
     FILE *ofp = NULL;
     PcmContext pf;
     CommandOptions opts;
     AftenContext s;
     uint32_t samplecount, bytecount, t0, t1, percent;
-    FLOAT kbps, qual, bw;
+    FLOAT kbps, qual, bw, passes;
     int frame_cnt;
     int input_file_format;
     enum PcmSampleFormat read_format;
@@ -130,6 +131,7 @@ main(int argc, char **argv)
     }
 
     memset(ifp, 0, A52_NUM_SPEAKERS * sizeof(FILE *));
+    memset(&pf, 0, sizeof(PcmContext));
     for (i = 0; i < opts.num_input_files; i++) {
         if (!strncmp(opts.infile[i], "-", 2)) {
 #ifdef _WIN32
@@ -259,15 +261,23 @@ main(int argc, char **argv)
         goto error_end;
 
     samplecount = bytecount = t0 = t1 = percent = 0;
-    qual = bw = 0.0;
+    qual = bw = passes = 0.0;
     frame_cnt = 0;
     fs = 0;
     nr = 0;
 
+    // the encoder puts the input in A/52 order while converting it
     if (opts.chmap == 0)
-        aften_remap = aften_remap_wav_to_a52;
+        s.channel_order = AFTEN_CH_ORDER_WAV;
     else if (opts.chmap == 2)
-        aften_remap = aften_remap_mpeg_to_a52;
+        s.channel_order = AFTEN_CH_ORDER_MPEG;
+
+    if (opts.io_uring && pcm_set_io_uring(&pf, opts.io_uring) && s.verbose > 0)
+        fprintf(stderr, "io_uring cannot be used for this input, using normal reads\n");
+
+    if (opts.read_ahead &&
+            pcm_start_read_ahead(&pf, A52_SAMPLES_PER_FRAME, opts.read_ahead))
+        goto error_end;
 
     // Don't pad start with zero samples, use input audio instead.
     if (!opts.pad_start) {
@@ -278,8 +288,6 @@ main(int argc, char **argv)
             memmove(fwav + diff * s.channels, fwav, nr);
             memset(fwav, 0, diff * s.channels * sizeof(FLOAT));
         }
-        if (aften_remap)
-            aften_remap(fwav + diff, nr, s.channels, s.sample_format, s.acmod);
 
         s.initial_samples = fwav;
     }
@@ -294,12 +302,21 @@ main(int argc, char **argv)
     // print number of threads used
     fprintf(stderr, "Threads: %i\n\n", s.system.n_threads);
 
-    do {
-        nr = pcm_read_samples(&pf, fwav, A52_SAMPLES_PER_FRAME);
-        if (aften_remap)
-            aften_remap(fwav, nr, s.channels, s.sample_format, s.acmod);
+    // the input is converted straight into one buffer per channel, and the
+    // encoder takes the channels in input order.  the read-ahead ring holds
+    // interleaved frames, so it keeps the interleaved path.
+    planar = !opts.read_ahead;
+    for (i = 0; i < s.channels; i++)
+        fchan[i] = fwav + i * A52_SAMPLES_PER_FRAME;
 
-        fs = aften_encode_frame(&s, frame, fwav, nr);
+    do {
+        if (planar) {
+            nr = pcm_read_samples_planar(&pf, (void **)fchan, A52_SAMPLES_PER_FRAME);
+            fs = aften_encode_frame_planar(&s, frame, (const void *const *)fchan, nr);
+        } else {
+            nr = pcm_read_samples(&pf, fwav, A52_SAMPLES_PER_FRAME);
+            fs = aften_encode_frame(&s, frame, fwav, nr);
+        }
 
         if (fs < 0) {
             fprintf(stderr, "Error encoding frame %d\n", frame_cnt);
@@ -310,6 +327,7 @@ main(int argc, char **argv)
                 bytecount += fs;
                 qual += s.status.quality;
                 bw += s.status.bwcode;
+                passes += s.status.bit_alloc_passes;
                 if (s.verbose == 1) {
                     current_clock = clock();
                     if (current_clock - last_update_clock >= update_clock_span) {
@@ -356,7 +374,14 @@ main(int argc, char **argv)
             fprintf(stderr, "\n");
             fprintf(stderr, "average quality:   %4.1f\n", (qual / frame_cnt));
             fprintf(stderr, "average bandwidth: %2.1f\n", (bw / frame_cnt));
-            fprintf(stderr, "average bitrate:   %4.1f kbps\n\n", kbps);
+            fprintf(stderr, "average bitrate:   %4.1f kbps\n", kbps);
+            fprintf(stderr, "average bit allocation passes: %4.2f\n\n", (passes / frame_cnt));
+        }
+        if (opts.read_ahead) {
+            int reader_stalls, encoder_stalls;
+            pcm_get_read_ahead_stalls(&pf, &reader_stalls, &encoder_stalls);
+            fprintf(stderr, "read-ahead stalls: reader %d, encoder %d\n\n",
+                    reader_stalls, encoder_stalls);
         }
     }
     goto end;
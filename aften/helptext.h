@@ -27,7 +27,7 @@
 
 static const char *usage_heading = "usage: aften [options] <input.wav> <output.ac3>\n";
 
-#define HELP_OPTIONS_COUNT 43
+#define HELP_OPTIONS_COUNT 47
 
 static const char *help_options[HELP_OPTIONS_COUNT] = {
 "    [-h]           Print out list of commandline options\n",
@@ -45,13 +45,21 @@ static const char *help_options[HELP_OPTIONS_COUNT] = {
 "                       0 = detect number of CPUs (default)\n",
 
 "    [-nosimd X]    Comma-separated list of SIMD instruction sets not to use\n"
-"                       Available sets are mmx, sse, sse2, sse3 and altivec.\n"
+"                       Available sets are mmx, sse, sse2, sse3, pclmul and\n"
+"                       altivec.\n"
 "                       No spaces are allowed between the sets and the commas.\n",
 
+"    [-hugepages #] Encoder memory pages\n"
+"                       0 = use normal pages (default)\n"
+"                       1 = ask for transparent huge pages\n",
+
 "    [-b #]         CBR bitrate in kbps (default: about 96kbps per channel)\n",
 
 "    [-q #]         VBR quality [0 - 1023] (default: 240)\n",
 
+"    [-abr #]       ABR mode with # frames of lookahead [1 - 32]\n"
+"                       -b sets the average bitrate\n",
+
 "    [-fba #]       Fast bit allocation (default: 0)\n"
 "                       0 = more accurate encoding\n"
 "                       1 = faster encoding\n",
@@ -159,6 +167,12 @@ static const char *help_options[HELP_OPTIONS_COUNT] = {
 "                       0 = use data size in header (default)\n"
 "                       1 = read data until end-of-file\n",
 
+"    [-readahead #] Frames of input to read ahead in a separate thread\n"
+"                       0 = read input when it is needed (default)\n",
+
+"    [-iouring #]   Input reads to keep in flight with io_uring (Linux)\n"
+"                       0 = use normal reads (default)\n",
+
 "    [-bwfilter #]  Specify use of the bandwidth low-pass filter\n"
 "                       0 = do not apply filter (default)\n"
 "                       1 = apply filter\n",
@@ -233,7 +247,7 @@ static const char *console_options[CONSOLE_OPTIONS_COUNT] = {
 "                       2 - Shows the statistics for each frame.\n"
 };
 
-#define ENCODING_OPTIONS_COUNT 12
+#define ENCODING_OPTIONS_COUNT 14
 
 static const char encoding_heading[18] = "ENCODING OPTIONS\n";
 static const char *encoding_options[ENCODING_OPTIONS_COUNT] = {
@@ -248,10 +262,18 @@ static const char *encoding_options[ENCODING_OPTIONS_COUNT] = {
 "                       Aften will auto-detect available SIMD instruction sets\n"
 "                       for your CPU, so you shouldn't need to disable sets\n"
 "                       explicitly - unless for speed or debugging reasons.\n"
-"                       Available sets are mmx, sse, sse2, sse3 and altivec.\n"
+"                       Available sets are mmx, sse, sse2, sse3, pclmul and\n"
+"                       altivec.\n"
 "                       No spaces are allowed between the sets and the commas.\n"
 "                       Example: -nosimd sse2,sse3\n",
 
+"    [-hugepages #] Huge pages\n"
+"                       All encoder memory is allocated from one arena.  Setting\n"
+"                       this to 1 asks the system to back the arena with\n"
+"                       transparent huge pages, which can reduce TLB misses.  It\n"
+"                       is only a hint and has no effect where the system does\n"
+"                       not support it.  The default is 0.\n",
+
 "    [-b #]         CBR bitrate in kbps\n"
 "                       CBR mode is selected by default. This option allows for\n"
 "                       setting the fixed bitrate. The default bitrate depends\n"
@@ -268,6 +290,17 @@ static const char *encoding_options[ENCODING_OPTIONS_COUNT] = {
 "                       value.  This scale will most likely be replaced in the\n"
 "                       future with a better quality measurement.\n",
 
+"    [-abr #]       ABR lookahead\n"
+"                       Selects average bitrate mode.  The frame size is chosen\n"
+"                       for each frame so the stream averages to the bitrate\n"
+"                       set with -b, which may be any value from 32 to 640.\n"
+"                       A bit reservoir lets complex passages borrow bits\n"
+"                       saved on simpler ones.  This value is the number of\n"
+"                       frames analyzed ahead of the current frame, from 1 to\n"
+"                       32.  Higher values react more smoothly to changes in\n"
+"                       complexity, but use more memory and add more delay.\n"
+"                       ABR mode always encodes in a single thread.\n",
+
 "    [-fba #]      Fast bit allocation\n"
 "                       Fast bit allocation is a less-accurate search method\n"
 "                       for CBR bit allocation.  It only narrows down the SNR\n"
@@ -409,7 +442,7 @@ static const char *drc_options[DRC_OPTIONS_COUNT] = {
 "                       -31dB.\n"
 };
 
-#define INPUT_OPTIONS_COUNT 10
+#define INPUT_OPTIONS_COUNT 12
 
 static const char input_heading[17] = "INPUT OPTIONS\n";
 static const char *input_options[INPUT_OPTIONS_COUNT] = {
@@ -496,7 +529,22 @@ static const char *input_options[INPUT_OPTIONS_COUNT] = {
 "                       can be useful for streaming input or files larger than\n"
 "                       4 GB.\n"
 "                       0 = use data size in header (default)\n"
-"                       1 = read data until end-of-file\n"
+"                       1 = read data until end-of-file\n",
+
+"    [-readahead #] Frames of input to read ahead in a separate thread.\n"
+"                       A reader thread keeps up to this many frames read and\n"
+"                       converted, so slow disks or pipes do not hold up the\n"
+"                       encoder.  With -v 1 or higher, the number of times\n"
+"                       the reader waited for the encoder and the encoder\n"
+"                       waited for the reader are printed at the end.\n"
+"                       0 = read input when it is needed (default)\n",
+
+"    [-iouring #]   Input reads to keep in flight with io_uring (Linux).\n"
+"                       Each input file is read in 512 kB blocks, with up to\n"
+"                       64 reads queued to the kernel at once.  Input which\n"
+"                       is not a regular file, or systems without io_uring,\n"
+"                       use normal reads.\n"
+"                       0 = use normal reads (default)\n"
 };
 
 #define FILTER_OPTIONS_COUNT 3
@@ -160,10 +160,12 @@ parse_nosimd(PARSE_PARAMS)
             wanted_simd_instructions->sse2 = 0;
         else if (!strncmp(&simd[i], "sse3", 5))
             wanted_simd_instructions->sse3 = 0;
+        else if (!strncmp(&simd[i], "pclmul", 7))
+            wanted_simd_instructions->pclmul = 0;
         else if (!strncmp(&simd[i], "altivec", 8))
             wanted_simd_instructions->altivec = 0;
         else {
-            fprintf(stderr, "invalid simd instruction set: %s. must be mmx, sse, sse2, sse3 or altivec.\n", &simd[i]);
+            fprintf(stderr, "invalid simd instruction set: %s. must be mmx, sse, sse2, sse3, pclmul or altivec.\n", &simd[i]);
             return 1;
         }
         if (last)
@@ -172,6 +174,14 @@ parse_nosimd(PARSE_PARAMS)
     return 0;
 }
 
+static int
+parse_abr(PARSE_PARAMS)
+{
+    opts->s->params.encoding_mode = AFTEN_ENC_MODE_ABR;
+    return parse_integer_value(atoi(param), item->min, item->max, arg,
+                               &opts->s->params.abr_lookahead);
+}
+
 static int
 parse_q(PARSE_PARAMS)
 {
@@ -354,7 +364,7 @@ parse_xbsi2_opt(PARSE_PARAMS)
     return parse_simple_int_s(arg, param, item, opts, priv);
 }
 
-#define OPTION_ITEM_COUNT 43
+#define OPTION_ITEM_COUNT 47
 
 /**
  * list of commandline options, in alphabetical order.
@@ -362,6 +372,7 @@ parse_xbsi2_opt(PARSE_PARAMS)
 static const OptionItem options_list[OPTION_ITEM_COUNT] = {
 //     NAME         FLAGS                         MIN             MAX   PARSE FUNCTION      OFFSET
 //    ------       -------                       -----           ----- ----------------    --------
+    { "abr",        OPTION_FLAGS_NONE,              1,             32,  parse_abr,          0                                                   },
     { "acmod",      OPTION_FLAGS_NONE,              0,              7,  parse_simple_int_s, offsetof(AftenContext, acmod)                       },
     { "adconvtyp",  OPTION_FLAGS_NONE,              0,              1,  parse_simple_int_s, offsetof(AftenContext, meta.adconvtyp)              },
     { "b",          OPTION_FLAGS_NONE,              0,            640,  parse_simple_int_s, offsetof(AftenContext, params.bitrate)              },
@@ -380,6 +391,8 @@ static const OptionItem options_list[OPTION_ITEM_COUNT] = {
     { "exps",       OPTION_FLAGS_NONE,              1,             32,  parse_simple_int_s, offsetof(AftenContext, params.expstr_search)        },
     { "fba",        OPTION_FLAGS_NONE,              0,              1,  parse_simple_int_s, offsetof(AftenContext, params.bitalloc_fast)        },
     { "h",          OPTION_FLAG_NO_PARAM,           0,              0,  parse_h,            0                                                   },
+    { "hugepages",  OPTION_FLAGS_NONE,              0,              1,  parse_simple_int_s, offsetof(AftenContext, system.use_huge_pages)       },
+    { "iouring",    OPTION_FLAGS_NONE,              0,             64,  parse_simple_int_o, offsetof(CommandOptions, io_uring)                  },
     { "lfe",        OPTION_FLAGS_NONE,              0,              1,  parse_simple_int_s, offsetof(AftenContext, lfe)                         },
     { "lfefilter",  OPTION_FLAGS_NONE,              0,              1,  parse_simple_int_s, offsetof(AftenContext, params.use_lfe_filter)       },
     { "longhelp",   OPTION_FLAG_NO_PARAM,           0,              0,  parse_longhelp,     0                                                   },
@@ -394,6 +407,7 @@ static const OptionItem options_list[OPTION_ITEM_COUNT] = {
     { "raw_ch",     OPTION_FLAGS_NONE,              1,              6,  parse_raw_option,   offsetof(CommandOptions, raw_ch)                    },
     { "raw_fmt",    OPTION_FLAGS_NONE,              0,              0,  parse_raw_fmt,      0                                                   },
     { "raw_sr",     OPTION_FLAGS_NONE,              1,          48000,  parse_raw_option,   offsetof(CommandOptions, raw_sr)                    },
+    { "readahead",  OPTION_FLAGS_NONE,              0,            256,  parse_simple_int_o, offsetof(CommandOptions, read_ahead)                },
     { "readtoeof",  OPTION_FLAGS_NONE,              0,              1,  parse_simple_int_o, offsetof(CommandOptions, read_to_eof)               },
     { "s",          OPTION_FLAGS_NONE,              0,              1,  parse_simple_int_s, offsetof(AftenContext, params.use_block_switching)  },
     { "smix",       OPTION_FLAGS_NONE,              0,              2,  parse_simple_int_s, offsetof(AftenContext, meta.surmixlev)              },
@@ -424,6 +438,8 @@ parse_commandline(int argc, char **argv, CommandOptions *opts)
     opts->outfile = NULL;
     opts->pad_start = 1;
     opts->read_to_eof = 0;
+    opts->read_ahead = 0;
+    opts->io_uring = 0;
     opts->raw_input = 0;
     opts->raw_fmt = PCM_SAMPLE_FMT_S16;
     opts->raw_order = PCM_BYTE_ORDER_LE;
@@ -40,6 +40,8 @@ typedef struct {
     AftenContext *s;
     int pad_start;
     int read_to_eof;
+    int read_ahead;
+    int io_uring;
     int raw_input;
     enum PcmSampleFormat raw_fmt;
     int raw_order;
@@ -43,6 +43,12 @@ int FrameEncoder::Encode(unsigned char *frameBuffer, const void *samples, int co
     return aften_encode_frame(&m_context, frameBuffer, samples, count);
 }
 
+/// Encodes planar PCM samples, one pointer per channel, to an A/52 frame
+int FrameEncoder::EncodePlanar(unsigned char *frameBuffer, const void *const *samples, int count)
+{
+    return aften_encode_frame_planar(&m_context, frameBuffer, samples, count);
+}
+
 /// Gets a context with default values
 AftenContext FrameEncoder::GetDefaultsContext()
 {
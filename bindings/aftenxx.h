@@ -49,6 +49,10 @@ public:
     /// Encodes PCM samples to an A/52 frame; returns encoded frame size
     int Encode(unsigned char *frameBuffer, const void *samples, int count);
 
+    /// Encodes planar PCM samples, one pointer per channel, to an A/52 frame;
+    /// returns encoded frame size
+    int EncodePlanar(unsigned char *frameBuffer, const void *const *samples, int count);
+
     /// Gets a context with default values
     static AftenContext GetDefaultsContext();
 };
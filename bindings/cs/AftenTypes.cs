@@ -17,6 +17,7 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA *
  ********************************************************************************/
 using System;
+using System.Runtime.InteropServices;
 
 namespace Aften
 {
@@ -57,7 +58,11 @@ namespace Aften
 		/// <summary>
 		/// VBR
 		/// </summary>
-		Vbr
+		Vbr,
+		/// <summary>
+		/// ABR
+		/// </summary>
+		Abr
 	}
 
 	/// <summary>
@@ -114,6 +119,29 @@ namespace Aften
 		Int8
 	}
 
+	/// <summary>
+	/// Channel order of the input samples
+	/// </summary>
+	public enum ChannelOrder
+	{
+		/// <summary>
+		/// A/52 order
+		/// </summary>
+		A52 = 0,
+		/// <summary>
+		/// WAV order
+		/// </summary>
+		Wav,
+		/// <summary>
+		/// MPEG order
+		/// </summary>
+		Mpeg,
+		/// <summary>
+		/// Order given by ChannelMap
+		/// </summary>
+		Custom
+	}
+
 	/// <summary>
 	/// Dynamic Range Profiles
 	/// </summary>
@@ -225,6 +253,10 @@ namespace Aften
 		/// PowerPC Altivec
 		/// </summary>
 		public bool Altivec;
+		/// <summary>
+		/// Carry-less multiplication (PCLMULQDQ)
+		/// </summary>
+		public bool Pclmul;
 	}
 
 	/// <summary>
@@ -249,6 +281,15 @@ namespace Aften
 		/// Wanted SIMD instruction sets
 		/// </summary>
 		public SimdInstructions WantedSimdInstructions;
+
+		/// <summary>
+		/// Huge pages option.
+		/// All encoder memory is allocated from one arena.  Set to true to ask
+		/// for the arena to be backed by transparent huge pages where the
+		/// system supports them.
+		/// default is false
+		/// </summary>
+		public bool UseHugePages;
 	}
 
 	/// <summary>
@@ -260,6 +301,7 @@ namespace Aften
 		/// Bitrate selection mode.
 		/// AFTEN_ENC_MODE_CBR : constant bitrate
 		/// AFTEN_ENC_MODE_VBR : variable bitrate
+		/// AFTEN_ENC_MODE_ABR : average bitrate
 		/// default is CBR
 		/// </summary>
 		public EncodingMode EncodingMode;
@@ -312,6 +354,8 @@ namespace Aften
 		/// default is 0
 		/// For CBR mode, this selects bitrate based on the number of channels.
 		/// For VBR mode, this sets the maximum bitrate to 640 kbps.
+		/// For ABR mode, this sets the average bitrate. Any value within the range
+		/// of valid bitrates may be used, and 0 selects the same default as CBR.
 		/// </summary>
 		public int Bitrate;
 
@@ -382,6 +426,17 @@ namespace Aften
 		/// default is 60.
 		/// </summary>
 		public int MaximumBandwidthCode;
+
+		/// <summary>
+		/// ABR lookahead.
+		/// For use with average bitrate mode, this option sets the number of
+		/// frames analyzed ahead of the frame being encoded.  Output is delayed by
+		/// this many frames.  The bit reservoir holds one more frame than the
+		/// lookahead at the average bitrate.
+		/// minimum is 1, maximum is 32
+		/// default is 8.
+		/// </summary>
+		public int AbrLookahead;
 	}
 
 	/// <summary>
@@ -482,6 +537,11 @@ namespace Aften
 		/// BandwidthCode
 		/// </summary>
 		public int BandwidthCode;
+
+		/// <summary>
+		/// Number of bit allocation passes used to encode the frame
+		/// </summary>
+		public int BitAllocationPasses;
 	}
 
 	/// <summary>
@@ -551,6 +611,21 @@ namespace Aften
 		/// </summary>
 		internal A52SampleFormat SampleFormat;
 
+		/// <summary>
+		/// Channel order of the input samples
+		/// The encoder puts the channels in A/52 order while converting the input.
+		/// default: A52
+		/// </summary>
+		public ChannelOrder ChannelOrder;
+
+		/// <summary>
+		/// Custom channel order
+		/// For ChannelOrder.Custom, A/52 channel i is taken from input channel
+		/// ChannelMap[i].
+		/// </summary>
+		[MarshalAs( UnmanagedType.ByValArray, SizeConst = 6 )]
+		public int[] ChannelMap;
+
 	#pragma warning disable 0169
 		/// <summary>
 		/// Initial samples
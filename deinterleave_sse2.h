@@ -0,0 +1,166 @@
+/**
+ * Aften: A/52 audio encoder
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file deinterleave_sse2.h
+ * SSE2 deinterleave kernels
+ *
+ * Shared by the encoder input conversion and the PCM library planar reads,
+ * so it depends on neither library.
+ *
+ * Input is read 4 frames at a time, which is a whole number of vectors for
+ * any channel count.  The frames are converted to float in their
+ * interleaved order, then shuffled into one vector per channel.  Only 1, 2
+ * and 6 channels are vectorized; other channel counts use the scalar loop.
+ * Callers should pass a constant 'nch' so each count gets its own loop.
+ */
+
+#ifndef DEINTERLEAVE_SSE2_H
+#define DEINTERLEAVE_SSE2_H
+
+#include "common.h"
+
+#include <emmintrin.h>
+
+#define DEINTERLEAVE_SSE2_NCH(nch) ((nch) == 1 || (nch) == 2 || (nch) == 6)
+
+/**
+ * Scales 4 frames of 'nch' interleaved channels, held in 'nch' vectors,
+ * and stores them to the planar channels at offset 'i'.
+ */
+static inline void
+deinterleave_store_sse2(float **dest, int i, const __m128 *v, int nch,
+                        __m128 scale)
+{
+    __m128 a, b, c, d;
+
+    switch (nch) {
+    case 1:
+        _mm_storeu_ps(dest[0]+i, _mm_mul_ps(v[0], scale));
+        break;
+    case 2:
+        // [L0 R0 L1 R1] [L2 R2 L3 R3]
+        a = _mm_shuffle_ps(v[0], v[1], _MM_SHUFFLE(2,0,2,0));
+        b = _mm_shuffle_ps(v[0], v[1], _MM_SHUFFLE(3,1,3,1));
+        _mm_storeu_ps(dest[0]+i, _mm_mul_ps(a, scale));
+        _mm_storeu_ps(dest[1]+i, _mm_mul_ps(b, scale));
+        break;
+    case 6:
+        // frames p,q,r,s:  [p0 p1 p2 p3] [p4 p5 q0 q1] [q2 q3 q4 q5]
+        //                  [r0 r1 r2 r3] [r4 r5 s0 s1] [s2 s3 s4 s5]
+        // channels 0-3 are a 4x4 transpose of the first 4 samples of
+        // each frame
+        a = v[0];
+        b = _mm_shuffle_ps(v[1], v[2], _MM_SHUFFLE(1,0,3,2));
+        c = v[3];
+        d = _mm_shuffle_ps(v[4], v[5], _MM_SHUFFLE(1,0,3,2));
+        _MM_TRANSPOSE4_PS(a, b, c, d);
+        _mm_storeu_ps(dest[0]+i, _mm_mul_ps(a, scale));
+        _mm_storeu_ps(dest[1]+i, _mm_mul_ps(b, scale));
+        _mm_storeu_ps(dest[2]+i, _mm_mul_ps(c, scale));
+        _mm_storeu_ps(dest[3]+i, _mm_mul_ps(d, scale));
+        // [p4 p5 q4 q5] [r4 r5 s4 s5]
+        a = _mm_shuffle_ps(v[1], v[2], _MM_SHUFFLE(3,2,1,0));
+        b = _mm_shuffle_ps(v[4], v[5], _MM_SHUFFLE(3,2,1,0));
+        c = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2,0,2,0));
+        d = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3,1,3,1));
+        _mm_storeu_ps(dest[4]+i, _mm_mul_ps(c, scale));
+        _mm_storeu_ps(dest[5]+i, _mm_mul_ps(d, scale));
+        break;
+    }
+}
+
+static inline void
+deinterleave_s16_sse2(float **dest, const int16_t *src, int nch, int n,
+                      float scale)
+{
+    __m128 v[6];
+    __m128 vscale = _mm_set1_ps(scale);
+    __m128i x;
+    int i, k, ch;
+
+    i = 0;
+    if (DEINTERLEAVE_SSE2_NCH(nch)) {
+        for (; i + 4 <= n; i += 4) {
+            if (nch == 1) {
+                x = _mm_loadl_epi64((const __m128i *)src);
+                v[0] = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16));
+            } else {
+                for (k = 0; k < nch; k += 2) {
+                    x = _mm_loadu_si128((const __m128i *)(src + 4*k));
+                    v[k  ] = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16));
+                    v[k+1] = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16));
+                }
+            }
+            deinterleave_store_sse2(dest, i, v, nch, vscale);
+            src += 4 * nch;
+        }
+    }
+    for (; i < n; i++) {
+        for (ch = 0; ch < nch; ch++)
+            dest[ch][i] = *src++ * scale;
+    }
+}
+
+static inline void
+deinterleave_s32_sse2(float **dest, const int32_t *src, int nch, int n,
+                      float scale)
+{
+    __m128 v[6];
+    __m128 vscale = _mm_set1_ps(scale);
+    int i, k, ch;
+
+    i = 0;
+    if (DEINTERLEAVE_SSE2_NCH(nch)) {
+        for (; i + 4 <= n; i += 4) {
+            for (k = 0; k < nch; k++)
+                v[k] = _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i *)(src + 4*k)));
+            deinterleave_store_sse2(dest, i, v, nch, vscale);
+            src += 4 * nch;
+        }
+    }
+    for (; i < n; i++) {
+        for (ch = 0; ch < nch; ch++)
+            dest[ch][i] = *src++ * scale;
+    }
+}
+
+static inline void
+deinterleave_float_sse2(float **dest, const float *src, int nch, int n)
+{
+    __m128 v[6];
+    __m128 vscale = _mm_set1_ps(1.0f);
+    int i, k, ch;
+
+    i = 0;
+    if (DEINTERLEAVE_SSE2_NCH(nch)) {
+        for (; i + 4 <= n; i += 4) {
+            for (k = 0; k < nch; k++)
+                v[k] = _mm_loadu_ps(src + 4*k);
+            deinterleave_store_sse2(dest, i, v, nch, vscale);
+            src += 4 * nch;
+        }
+    }
+    for (; i < n; i++) {
+        for (ch = 0; ch < nch; ch++)
+            dest[ch][i] = *src++;
+    }
+}
+
+#endif /* DEINTERLEAVE_SSE2_H */
@@ -198,6 +198,18 @@ void a52_bit_alloc_calc_bap(int16_t *mask, int16_t *psd, int start, int end,
     } while (end > band_start_tab[band++]);
 }
 
+void a52_bit_alloc_calc_bap_hist(int16_t *mask, int16_t *psd, int start,
+                                 int end, int floor, int weight, int *hist)
+{
+    int bin;
+
+    for (bin = start; bin < end; bin++) {
+        int m = (MAX(mask[bin_to_band_tab[bin]] - floor, 0) & 0x1FE0) + floor;
+        int address = CLIP((psd[bin] - m) >> 5, -128, 127);
+        hist[address+128] += weight;
+    }
+}
+
 /**
  * Initializes some tables.
  */
@@ -74,24 +74,26 @@ typedef enum {
     DBA_RESERVED
 } AC3DeltaStrategy;
 
+/**
+ * The per-channel arrays of a block point into the frame's buffer, which
+ * only holds the channels in use.
+ */
 typedef struct A52Block {
-    FLOAT *input_samples[A52_MAX_CHANNELS]; /* 512 per ch */
+    FLOAT *input_samples[A52_MAX_CHANNELS]; /* 512 per ch, in filtered_audio */
     FLOAT *mdct_coef[A52_MAX_CHANNELS]; /* 256 per ch */
-    FLOAT transient_samples[A52_MAX_CHANNELS][512];
+    uint8_t *exp[A52_MAX_CHANNELS];     /* 256 per ch */
+    uint8_t *bap[A52_MAX_CHANNELS];     /* 256 per ch */
+    int16_t *psd[A52_MAX_CHANNELS];     /* 256 per ch */
+    int16_t *mask[A52_MAX_CHANNELS];    /* 50 per ch */
+    uint8_t *grp_exp[A52_MAX_CHANNELS]; /* 85 per ch */
     int block_num;
-    int blksw[A52_MAX_CHANNELS];
-    int dithflag[A52_MAX_CHANNELS];
     int dynrng;
-    uint8_t exp[A52_MAX_CHANNELS][256];
-    int16_t psd[A52_MAX_CHANNELS][256];
-    int16_t mask[A52_MAX_CHANNELS][50];
+    int write_snr;
+    uint8_t blksw[A52_MAX_CHANNELS];
+    uint8_t dithflag[A52_MAX_CHANNELS];
+    uint8_t fgaincod[A52_MAX_CHANNELS];
     uint8_t exp_strategy[A52_MAX_CHANNELS];
     uint8_t nexpgrps[A52_MAX_CHANNELS];
-    uint8_t grp_exp[A52_MAX_CHANNELS][85];
-    uint8_t bap[A52_MAX_CHANNELS][256];
-    uint16_t qmant[A52_MAX_CHANNELS][256];
-    int fgaincod[A52_MAX_CHANNELS];
-    int write_snr;
 } A52Block;
 
 typedef struct A52BitAllocParams {
@@ -107,11 +109,21 @@ typedef struct A52Frame {
     int bit_rate;
     int bwcode;
 
-    FLOAT input_audio[A52_MAX_CHANNELS][A52_SAMPLES_PER_FRAME];
+    void *buffer;   ///< holds all per-channel arrays of the frame and its blocks
+    /**
+     * Filtered input, and its high-pass output for transient detection,
+     * starting 256 samples before the frame.  Block n of each channel is a
+     * view of the 512 samples starting at 256*n.  The input is converted
+     * into the filtered audio, and filtered in place.
+     */
+    FLOAT *input_audio[A52_MAX_CHANNELS];      /* A52_SAMPLES_PER_FRAME per ch, filtered_audio + 256 */
+    FLOAT *filtered_audio[A52_MAX_CHANNELS];   /* 256+A52_SAMPLES_PER_FRAME per ch */
+    FLOAT *transient_audio[A52_MAX_CHANNELS];  /* 256+A52_SAMPLES_PER_FRAME per ch, if block switching */
     A52Block blocks[A52_NUM_BLOCKS];
     int frame_bits;
     int exp_bits;
     int mant_bits;
+    int bit_alloc_passes;
     unsigned int frame_size_min; // minimum frame size
     unsigned int frame_size;     // current frame size in words
     unsigned int frmsizecod;
@@ -124,6 +136,10 @@ typedef struct A52Frame {
     int ncoefs[A52_MAX_CHANNELS];
     int expstr_set[A52_MAX_CHANNELS];
     uint8_t rematflg[4];
+
+    // ABR bit demand estimate (total frame bits at 2 quality levels)
+    int est_quality;
+    int est_bits[2];
 } A52Frame;
 
 void a52_common_init(void);
@@ -188,4 +204,22 @@ void a52_bit_alloc_calc_mask(A52BitAllocParams *s, int16_t *band_psd,
 void a52_bit_alloc_calc_bap(int16_t *mask, int16_t *psd, int start, int end,
                                int snr_offset, int floor, uint8_t *bap);
 
+/**
+ * Counts bap table addresses at an SNR offset of 0.
+ * For an SNR offset which is a multiple of 32, the address used by
+ * a52_bit_alloc_calc_bap is very nearly the address counted here plus
+ * snr_offset/32, so the histogram can be used to estimate mantissa bits at
+ * any SNR offset without recalculating the bit allocation pointers.
+ *
+ * @param[in]  mask       masking curve
+ * @param[in]  psd        signal power for each frequency bin
+ * @param[in]  start      starting bin location
+ * @param[in]  end        ending bin location
+ * @param[in]  floor      noise floor
+ * @param[in]  weight     amount added for each bin
+ * @param[out] hist       histogram of addresses -128 to 127, offset by 128
+ */
+void a52_bit_alloc_calc_bap_hist(int16_t *mask, int16_t *psd, int start,
+                                 int end, int floor, int weight, int *hist);
+
 #endif /* A52_H */
@@ -33,6 +33,7 @@
 #include "dynrng.h"
 #include "cpu_caps.h"
 #include "convert.h"
+#include "mem.h"
 
 /**
  * LUT for number of exponent groups present.
@@ -49,6 +50,7 @@ static int convert_samples_from_src(A52ThreadContext *tctx, const void *vsrc,
 
 static int begin_encode_frame(A52ThreadContext *tctx);
 static int begin_transcode_frame(A52ThreadContext *tctx);
+static void init_frame_header_template(A52Context *ctx);
 
 static int
 prepare_transcode_common(A52ThreadContext *tctx, const void *input_frame_buffer,
@@ -141,6 +143,9 @@ set_available_simd_instructions(AftenSimdInstructions *simd_instructions)
 #ifdef HAVE_SSE3
     simd_instructions->sse3 = cpu_caps_have_sse3();
 #endif
+#ifdef HAVE_PCLMUL
+    simd_instructions->pclmul = cpu_caps_have_pclmul();
+#endif
 /* Following SIMD code doesn't exist yet, so don't set it available */
 #if 0
 #ifdef HAVE_SSSE3
@@ -179,6 +184,7 @@ aften_set_defaults(AftenContext *s)
     set_available_simd_instructions(&s->system.available_simd_instructions);
     s->system.wanted_simd_instructions = s->system.available_simd_instructions;
     s->system.n_threads = 0;
+    s->system.use_huge_pages = 0;
 
     s->verbose = 1;
     s->channels = -1;
@@ -188,6 +194,7 @@ aften_set_defaults(AftenContext *s)
     s->mode = AFTEN_ENCODE;
 
     s->sample_format = A52_SAMPLE_FMT_S16;
+    s->channel_order = AFTEN_CH_ORDER_A52;
     s->private_context = NULL;
     s->params.encoding_mode = AFTEN_ENC_MODE_CBR;
     s->params.bitrate = 0;
@@ -203,6 +210,7 @@ aften_set_defaults(AftenContext *s)
     s->params.dynrng_profile = DYNRNG_PROFILE_NONE;
     s->params.min_bwcode = 0;
     s->params.max_bwcode = 60;
+    s->params.abr_lookahead = 8;
 
     s->meta.cmixlev = 0;
     s->meta.surmixlev = 0;
@@ -222,16 +230,173 @@ aften_set_defaults(AftenContext *s)
     s->status.quality = 0;
     s->status.bit_rate = 0;
     s->status.bwcode = 0;
+    s->status.bit_alloc_passes = 0;
 
     s->initial_samples = NULL;
 }
 
+/**
+ * Sets up which input channel feeds each A/52 channel.  The converter
+ * writes through a permuted array of channel pointers, so putting the
+ * input in A/52 order costs nothing.
+ */
+static int
+set_channel_map(A52Context *ctx, AftenContext *s)
+{
+    int ch, used;
+
+    for (ch = 0; ch < ctx->n_all_channels; ch++)
+        ctx->channel_src[ch] = ch;
+
+    switch (s->channel_order) {
+    case AFTEN_CH_ORDER_A52:
+        break;
+    case AFTEN_CH_ORDER_WAV:
+        for (ch = 0; ch < ctx->n_all_channels; ch++)
+            ctx->channel_src[ch] = a52_wav_chmap[ctx->acmod][ctx->lfe][ch];
+        break;
+    case AFTEN_CH_ORDER_MPEG:
+        if (ctx->acmod > 2 && (ctx->acmod & 1)) {
+            ctx->channel_src[0] = 1;
+            ctx->channel_src[1] = 0;
+        }
+        break;
+    case AFTEN_CH_ORDER_CUSTOM:
+        used = 0;
+        for (ch = 0; ch < ctx->n_all_channels; ch++) {
+            int src = s->channel_map[ch];
+            if (src < 0 || src >= ctx->n_all_channels || (used & (1 << src))) {
+                fprintf(stderr, "invalid channel map\n");
+                return -1;
+            }
+            used |= 1 << src;
+            ctx->channel_src[ch] = src;
+        }
+        break;
+    default:
+        fprintf(stderr, "invalid channel order\n");
+        return -1;
+    }
+    return 0;
+}
+
+/** places one array in the frame buffer, keeping each array 16-byte aligned */
+static void *
+frame_buffer_place(uint8_t *base, size_t *offset, size_t size)
+{
+    void *p = base ? base + *offset : NULL;
+    *offset += (size + 15) & ~(size_t)15;
+    return p;
+}
+
+/**
+ * Lays out the per-channel arrays of a frame and its blocks in one buffer.
+ * Only the channels in use get space.  Each channel's audio comes first,
+ * followed by its arrays for all blocks, since most stages work on one
+ * channel at a time.  With base NULL, only the size is computed.
+ * @return size of the buffer in bytes
+ */
+static size_t
+frame_buffer_layout(A52Frame *frame, int n_channels, int block_switching,
+                    uint8_t *base)
+{
+    A52Block *block;
+    size_t offset = 0;
+    size_t audio_size = (256 + A52_SAMPLES_PER_FRAME) * sizeof(FLOAT);
+    int ch, blk;
+
+    for (ch = 0; ch < n_channels; ch++) {
+        frame->filtered_audio[ch] = frame_buffer_place(base, &offset, audio_size);
+        frame->input_audio[ch] = base ? frame->filtered_audio[ch] + 256 : NULL;
+        frame->transient_audio[ch] = NULL;
+        if (block_switching)
+            frame->transient_audio[ch] = frame_buffer_place(base, &offset, audio_size);
+        for (blk = 0; blk < A52_NUM_BLOCKS; blk++) {
+            block = &frame->blocks[blk];
+            block->input_samples[ch] = base ? frame->filtered_audio[ch] + 256 * blk : NULL;
+            block->mdct_coef[ch] = frame_buffer_place(base, &offset, 256 * sizeof(FLOAT));
+            block->exp[ch] = frame_buffer_place(base, &offset, 256);
+            block->bap[ch] = frame_buffer_place(base, &offset, 256);
+            block->psd[ch] = frame_buffer_place(base, &offset, 256 * sizeof(int16_t));
+            block->mask[ch] = frame_buffer_place(base, &offset, 50 * sizeof(int16_t));
+            block->grp_exp[ch] = frame_buffer_place(base, &offset, 85);
+        }
+    }
+    return offset;
+}
+
+static int
+alloc_frame_buffer(A52ThreadContext *tctx)
+{
+    A52Context *ctx = tctx->ctx;
+    int n_channels = ctx->n_all_channels;
+    int bs = ctx->params.use_block_switching;
+    size_t size = frame_buffer_layout(&tctx->frame, n_channels, bs, NULL);
+
+    tctx->frame.buffer = mem_arena_alloc(ctx->arena, size);
+    if (!tctx->frame.buffer)
+        return -1;
+    frame_buffer_layout(&tctx->frame, n_channels, bs, tctx->frame.buffer);
+    return 0;
+}
+
+/** fixed-size tables allocated from the arena: MDCT tables and filter states */
+#define ARENA_TABLES_SIZE (32 * 1024)
+
+/**
+ * Estimates the memory used by an encoder, so that the arena normally
+ * needs only one block.  The parameters have not been validated yet, so
+ * they are clamped to their legal ranges.
+ */
+static size_t
+encoder_arena_size(AftenContext *s, int n_threads)
+{
+    A52Frame frame;
+    int n_tctx = n_threads;
+    int n_channels = CLIP(s->channels, 1, A52_MAX_CHANNELS);
+    int bs = s->params.use_block_switching;
+    size_t size;
+
+    if (s->params.encoding_mode == AFTEN_ENC_MODE_ABR)
+        n_tctx += CLIP(s->params.abr_lookahead, 1, 32);
+
+    size = sizeof(A52Context) + ARENA_TABLES_SIZE;
+    if (bs || s->params.use_dc_filter || s->params.use_bw_filter ||
+            s->params.use_lfe_filter) {
+        size += 2 * FILTER_CHAIN_STATE_SIZE * A52_SAMPLES_PER_FRAME * sizeof(FLOAT);
+    }
+    // thread context, MDCT buffers and frame buffer, plus alignment padding
+    size += n_tctx * (sizeof(A52ThreadContext) +
+                      ((512+2) + 512 + (256+2) + 256) * sizeof(FLOAT) +
+                      frame_buffer_layout(&frame, n_channels, bs, NULL) +
+                      7 * MEM_ARENA_ALIGN);
+    return size;
+}
+
+/**
+ * Number of threads used for encoding.
+ * ABR frames must pass through the lookahead queue in order, so they are
+ * encoded in a single thread with one context per queued frame.
+ */
+static int
+encoder_thread_count(AftenContext *s)
+{
+    int n_threads;
+
+    if (s->params.encoding_mode == AFTEN_ENC_MODE_ABR)
+        return 1;
+    n_threads = (s->system.n_threads > 0) ? s->system.n_threads : get_ncpus();
+    return MIN(n_threads, MAX_NUM_THREADS);
+}
+
 int
 aften_encode_init(AftenContext *s)
 {
     A52Context *ctx;
+    MemArena *arena;
     int i, j, brate;
     int last_quality;
+    int n_threads;
 
     if (s == NULL) {
         fprintf(stderr, "NULL parameter passed to aften_encode_init\n");
@@ -240,11 +405,21 @@ aften_encode_init(AftenContext *s)
     cpu_caps_detect();
     apply_simd_restrictions(&s->system.wanted_simd_instructions);
 
-    ctx = calloc(sizeof(A52Context), 1);
+    // the context, tables and all per-thread buffers come from one arena
+    n_threads = encoder_thread_count(s);
+    arena = mem_arena_create(encoder_arena_size(s, n_threads),
+                             s->system.use_huge_pages);
+    if (!arena) {
+        fprintf(stderr, "error allocating memory for A52Context\n");
+        return -1;
+    }
+    ctx = mem_arena_alloc(arena, sizeof(A52Context));
     if (!ctx) {
         fprintf(stderr, "error allocating memory for A52Context\n");
+        mem_arena_destroy(arena);
         return -1;
     }
+    ctx->arena = arena;
     mdct_init(ctx);
     s->private_context = ctx;
     ctx->params = s->params;
@@ -299,8 +474,6 @@ aften_encode_init(AftenContext *s)
 #endif
     }
     case AFTEN_ENCODE:
-        set_converter(ctx, s->sample_format);
-
     // channel configuration
         if (s->channels < 1 || s->channels > 6) {
             fprintf(stderr, "invalid number of channels\n");
@@ -324,6 +497,12 @@ aften_encode_init(AftenContext *s)
         ctx->n_channels = s->channels - s->lfe;
         ctx->lfe_channel = s->lfe ? (s->channels - 1) : -1;
 
+        if (set_channel_map(ctx, s))
+            return -1;
+
+        // the converter is chosen for the channel count
+        set_converter(ctx, s->sample_format);
+
         // frequency
         for (i=0;i<3;i++) {
             for (j=0;j<3;j++)
@@ -357,7 +536,8 @@ found:
 
     // bitrate & frame size
     brate = s->params.bitrate;
-    if (ctx->params.encoding_mode == AFTEN_ENC_MODE_CBR) {
+    if (ctx->params.encoding_mode == AFTEN_ENC_MODE_CBR ||
+            ctx->params.encoding_mode == AFTEN_ENC_MODE_ABR) {
         if (brate == 0) {
             switch (ctx->n_channels) {
                 case 1: brate =  96; break;
@@ -390,23 +570,52 @@ found:
     ctx->frmsizecod = i*2;
     ctx->target_bitrate = a52_bitrate_tab[i] >> ctx->halfratecod;
 
+    if (ctx->params.encoding_mode == AFTEN_ENC_MODE_ABR) {
+        if (brate < (a52_bitrate_tab[0] >> ctx->halfratecod) ||
+                brate > (a52_bitrate_tab[18] >> ctx->halfratecod)) {
+            fprintf(stderr, "invalid average bitrate\n");
+            return -1;
+        }
+        if (ctx->params.abr_lookahead < 1 || ctx->params.abr_lookahead > 32) {
+            fprintf(stderr, "invalid ABR lookahead: %d\n",
+                    ctx->params.abr_lookahead);
+            return -1;
+        }
+        // any frame size up to the maximum can be used
+        ctx->frmsizecod = 36;
+        ctx->target_bitrate = brate;
+    }
+
     if (ctx->params.expstr_search < 1 || ctx->params.expstr_search > 32) {
         fprintf(stderr, "invalid exponent strategy search size: %d\n",
                 ctx->params.expstr_search);
         return -1;
     }
 
+    init_frame_header_template(ctx);
+    count_const_frame_bits(ctx);
+
     crc_init();
     a52_window_init(&ctx->winf);
     exponent_init(&ctx->expf);
+    quantize_init(&ctx->quantf);
     dynrng_init();
 
     last_quality = 240;
     if (ctx->params.encoding_mode == AFTEN_ENC_MODE_VBR)
         last_quality = ctx->params.quality;
-    else if (ctx->params.encoding_mode == AFTEN_ENC_MODE_CBR)
+    else
         last_quality = ((((ctx->target_bitrate/ctx->n_channels)*35)/24)+95)+(25*ctx->halfratecod);
 
+    if (ctx->params.encoding_mode == AFTEN_ENC_MODE_ABR) {
+        // start with a half-full reservoir
+        ctx->rc.lookahead = ctx->params.abr_lookahead;
+        ctx->rc.quality = last_quality;
+        ctx->rc.target = (int64_t)ctx->target_bitrate * 1000 * A52_SAMPLES_PER_FRAME;
+        ctx->rc.size = ctx->rc.target * (ctx->rc.lookahead + 1);
+        ctx->rc.fill = ctx->rc.size / 2;
+    }
+
     if (s->params.bwcode < -2 || s->params.bwcode > 60) {
         fprintf(stderr, "invalid bandwidth code\n");
         return -1;
@@ -425,6 +634,10 @@ found:
                 fprintf(stderr, "variable bandwidth mode cannot be used with variable bitrate mode\n");
                 return -1;
             }
+            if (ctx->params.encoding_mode == AFTEN_ENC_MODE_ABR) {
+                fprintf(stderr, "variable bandwidth mode cannot be used with average bitrate mode\n");
+                return -1;
+            }
         }
         ctx->fixed_bwcode = CLIP(ctx->fixed_bwcode, ctx->params.min_bwcode,
                                  ctx->params.max_bwcode);
@@ -445,7 +658,8 @@ found:
                 ctx->bs_filter[i].cascaded = 1;
                 ctx->bs_filter[i].cutoff = 8000;
                 ctx->bs_filter[i].samplerate = (FLOAT)ctx->sample_rate;
-                if (filter_init(&ctx->bs_filter[i], FILTER_ID_BIQUAD_I)) {
+                if (filter_init(&ctx->bs_filter[i], FILTER_ID_BIQUAD_I,
+                                ctx->arena)) {
                     fprintf(stderr, "error initializing transient-detect filter\n");
                     return -1;
                 }
@@ -460,7 +674,8 @@ found:
                 ctx->dc_filter[i].cascaded = 0;
                 ctx->dc_filter[i].cutoff = 3;
                 ctx->dc_filter[i].samplerate = (FLOAT)ctx->sample_rate;
-                if (filter_init(&ctx->dc_filter[i], FILTER_ID_ONEPOLE)) {
+                if (filter_init(&ctx->dc_filter[i], FILTER_ID_ONEPOLE,
+                                ctx->arena)) {
                     fprintf(stderr, "error initializing dc filter\n");
                     return -1;
                 }
@@ -483,7 +698,8 @@ found:
                     ctx->bw_filter[i].cascaded = 1;
                     ctx->bw_filter[i].cutoff = (FLOAT)cutoff;
                     ctx->bw_filter[i].samplerate = (FLOAT)ctx->sample_rate;
-                    if (filter_init(&ctx->bw_filter[i], FILTER_ID_BUTTERWORTH_II)) {
+                    if (filter_init(&ctx->bw_filter[i], FILTER_ID_BUTTERWORTH_II,
+                                    ctx->arena)) {
                         fprintf(stderr, "error initializing bandwidth filter\n");
                         return -1;
                     }
@@ -502,31 +718,69 @@ found:
             ctx->lfe_filter.cascaded = 1;
             ctx->lfe_filter.cutoff = 120;
             ctx->lfe_filter.samplerate = (FLOAT)ctx->sample_rate;
-            if (filter_init(&ctx->lfe_filter, FILTER_ID_BUTTERWORTH_II)) {
+            if (filter_init(&ctx->lfe_filter, FILTER_ID_BUTTERWORTH_II,
+                            ctx->arena)) {
                 fprintf(stderr, "error initializing lfe filter\n");
                 return -1;
             }
         }
+
+        // DC filter, then bandwidth or LFE filter, with the transient-detect
+        // filter branching off after them
+        for (i = 0; i < ctx->n_all_channels; i++) {
+            FilterChain *c = &ctx->filter_chain[i];
+            c->pre = ctx->params.use_dc_filter ? &ctx->dc_filter[i] : NULL;
+            if (i < ctx->n_channels) {
+                c->main = ctx->params.use_bw_filter ? &ctx->bw_filter[i] : NULL;
+                c->tap = ctx->params.use_block_switching ? &ctx->bs_filter[i] : NULL;
+            } else {
+                c->main = ctx->params.use_lfe_filter ? &ctx->lfe_filter : NULL;
+                c->tap = NULL;
+            }
+            if (c->pre || c->main || c->tap)
+                ctx->use_filter_chain = 1;
+        }
+
+        // all full bandwidth channels use the same filters, so one model of
+        // the chain for them and one for the LFE channel is enough
+        if (ctx->use_filter_chain) {
+            if (filter_chain_model_init(&ctx->chain_model[0],
+                                        &ctx->filter_chain[0],
+                                        A52_SAMPLES_PER_FRAME, ctx->arena) ||
+                (ctx->lfe &&
+                 filter_chain_model_init(&ctx->chain_model[1],
+                                         &ctx->filter_chain[ctx->n_channels],
+                                         A52_SAMPLES_PER_FRAME, ctx->arena))) {
+                fprintf(stderr, "error initializing input filter model\n");
+                return -1;
+            }
+        }
     }
 
     // Initialize thread specific contexts
-    ctx->n_threads = (s->system.n_threads > 0) ? s->system.n_threads : get_ncpus();
-    ctx->n_threads = MIN(ctx->n_threads, MAX_NUM_THREADS);
+    ctx->n_threads = n_threads;
     s->system.n_threads = ctx->n_threads;
-    ctx->tctx = calloc(sizeof(A52ThreadContext), ctx->n_threads);
+    ctx->tctx = mem_arena_alloc(ctx->arena, sizeof(A52ThreadContext) *
+                                (ctx->n_threads + ctx->rc.lookahead));
+    if (!ctx->tctx) {
+        fprintf(stderr, "error allocating thread contexts\n");
+        return -1;
+    }
 
-    for (j = 0; j < ctx->n_threads; j++) {
+    for (j = 0; j < ctx->n_threads + ctx->rc.lookahead; j++) {
         A52ThreadContext *cur_tctx = &ctx->tctx[j];
         cur_tctx->ctx = ctx;
         cur_tctx->thread_num = j;
 
         mdct_thread_init(cur_tctx);
+        if (alloc_frame_buffer(cur_tctx)) {
+            fprintf(stderr, "error allocating frame buffers\n");
+            return -1;
+        }
 
         cur_tctx->bit_cnt = 0;
         cur_tctx->sample_cnt = 0;
 
-        cur_tctx->last_quality = last_quality;
-
         if (ctx->n_threads > 1) {
             cur_tctx->state = START;
 
@@ -589,7 +843,11 @@ found:
         ctx->begin_process_frame = begin_transcode_frame;
         for (j = 0; j < ctx->n_threads; j++) {
             A52ThreadContext *tctx = ctx->tctx + j;
-            tctx->dctx = calloc(sizeof(A52DecodeContext), 1);
+            tctx->dctx = mem_arena_alloc(ctx->arena, sizeof(A52DecodeContext));
+            if (!tctx->dctx) {
+                fprintf(stderr, "error allocating decode context\n");
+                return -1;
+            }
             a52_decode_init_thread(tctx);
         }
         break;
@@ -638,6 +896,7 @@ frame_init(A52ThreadContext *tctx)
     frame->frame_bits = 0;
     frame->exp_bits = 0;
     frame->mant_bits = 0;
+    frame->bit_alloc_passes = 0;
 
     // default bit allocation params
     frame->sdecaycod = 2;
@@ -649,21 +908,24 @@ frame_init(A52ThreadContext *tctx)
     return 0;
 }
 
-/* output the A52 frame header */
+/**
+ * Render the frame header once.  Everything except frmsizecod stays the same
+ * for the whole stream, so frmsizecod is left as zero and filled in by
+ * output_frame_header().
+ */
 static void
-output_frame_header(A52ThreadContext *tctx, uint8_t *frame_buffer)
+init_frame_header_template(A52Context *ctx)
 {
-    A52Context *ctx = tctx->ctx;
-    A52Frame *f = &tctx->frame;
-    BitWriter *bw = &tctx->bw;
-    int frmsizecod = f->frmsizecod+(f->frame_size-f->frame_size_min);
+    BitWriter bs;
+    BitWriter *bw = &bs;
 
-    bitwriter_init(bw, frame_buffer, A52_MAX_CODED_FRAME_SIZE);
+    memset(ctx->header_template, 0, sizeof(ctx->header_template));
+    bitwriter_init(bw, ctx->header_template, sizeof(ctx->header_template));
 
     bitwriter_writebits(bw, 16, 0x0B77); /* frame header */
     bitwriter_writebits(bw, 16, 0); /* crc1: will be filled later */
     bitwriter_writebits(bw, 2, ctx->fscod);
-    bitwriter_writebits(bw, 6, frmsizecod);
+    bitwriter_writebits(bw, 6, 0); /* frmsizecod: filled in every frame */
     bitwriter_writebits(bw, 5, ctx->bsid);
     bitwriter_writebits(bw, 3, ctx->bsmod);
     bitwriter_writebits(bw, 3, ctx->acmod);
@@ -708,122 +970,23 @@ output_frame_header(A52ThreadContext *tctx, uint8_t *frame_buffer)
         bitwriter_writebits(bw, 1, 0); // timecod2e
     }
     bitwriter_writebits(bw, 1, 0); /* no addtional bit stream info */
-}
-
-/* symmetric quantization on 'levels' levels */
-#define sym_quant(c, e, levels) \
-    ((((((levels) * (c)) >> (24-(e))) + 1) >> 1) + ((levels) >> 1))
-
-/* asymmetric quantization on 2^qbits levels */
-static inline int
-asym_quant(int c, int e, int qbits)
-{
-    int lshift, m, v;
-
-    lshift = e + (qbits-1) - 24;
-    if (lshift >= 0)
-        v = c << lshift;
-    else
-        v = c >> (-lshift);
-
-    m = (1 << (qbits-1));
-    v = CLIP(v, -m, m-1);
 
-    return v;
-}
-
-static void
-quant_mant_ch(FLOAT *mdct_coef, uint8_t *exp, uint8_t *bap, uint16_t *qmant,
-              int ncoefs, uint16_t *qmant_ptr[3], int mant_cnt[3])
-{
-    int i, c, e, b, v;
-
-    for (i = 0; i < ncoefs; i++) {
-        c = (int)(mdct_coef[i] * (1 << 24));
-        e = exp[i];
-        b = bap[i];
-        switch (b) {
-            case 0:
-                v = 0;
-                break;
-            case 1:
-                v = sym_quant(c, e, 3);
-                if (mant_cnt[0] == 0) {
-                    qmant_ptr[0] = &qmant[i];
-                    v = 9 * v;
-                } else if (mant_cnt[0] == 1) {
-                    *qmant_ptr[0] += 3 * v;
-                    v = 128;
-                } else {
-                    *qmant_ptr[0] += v;
-                    v = 128;
-                }
-                mant_cnt[0] = (mant_cnt[0] + 1) % 3;
-                break;
-            case 2:
-                v = sym_quant(c, e, 5);
-                if (mant_cnt[1] == 0) {
-                    qmant_ptr[1] = &qmant[i];
-                    v = 25 * v;
-                } else if (mant_cnt[1] == 1) {
-                    *qmant_ptr[1] += 5 * v;
-                    v = 128;
-                } else {
-                    *qmant_ptr[1] += v;
-                    v = 128;
-                }
-                mant_cnt[1] = (mant_cnt[1] + 1) % 3;
-                break;
-            case 3:
-                v = sym_quant(c, e, 7);
-                break;
-            case 4:
-                v = sym_quant(c, e, 11);
-                if (mant_cnt[2]== 0) {
-                    qmant_ptr[2] = &qmant[i];
-                    v = 11 * v;
-                } else {
-                    *qmant_ptr[2] += v;
-                    v = 128;
-                }
-                mant_cnt[2] = (mant_cnt[2] + 1) % 2;
-                break;
-            case 5:
-                v = sym_quant(c, e, 15);
-                break;
-            case 14:
-                v = asym_quant(c, e, 14);
-                break;
-            case 15:
-                v = asym_quant(c, e, 16);
-                break;
-            default:
-                v = asym_quant(c, e, b - 1);
-        }
-        qmant[i] = v;
-    }
+    ctx->header_bits = bitwriter_bitcount(bw);
+    bitwriter_flushbits(bw);
 }
 
+/* output the A52 frame header */
 static void
-quantize_mantissas(A52ThreadContext *tctx)
+output_frame_header(A52ThreadContext *tctx, uint8_t *frame_buffer)
 {
     A52Context *ctx = tctx->ctx;
-    A52Frame *frame = &tctx->frame;
-    A52Block *block;
-    uint16_t *qmant_ptr[3];
-    int blk, ch;
-    int mant_cnt[3];
+    A52Frame *f = &tctx->frame;
+    BitWriter *bw = &tctx->bw;
+    int frmsizecod = f->frmsizecod+(f->frame_size-f->frame_size_min);
 
-    for (blk = 0; blk < A52_NUM_BLOCKS; blk++) {
-        block = &frame->blocks[blk];
-        mant_cnt[0] = mant_cnt[1] = mant_cnt[2] = 0;
-        qmant_ptr[0] = qmant_ptr[1] = qmant_ptr[2] = NULL;
-        for (ch = 0; ch < ctx->n_all_channels; ch++) {
-            quant_mant_ch(block->mdct_coef[ch], block->exp[ch], block->bap[ch],
-                          block->qmant[ch], frame->ncoefs[ch], qmant_ptr,
-                          mant_cnt);
-        }
-    }
+    bitwriter_init(bw, frame_buffer, A52_MAX_CODED_FRAME_SIZE);
+    bitwriter_copybits(bw, ctx->header_template, ctx->header_bits);
+    bitwriter_patchbits(bw, 34, 6, frmsizecod);
 }
 
 /* Output each audio block. */
@@ -844,9 +1007,8 @@ output_audio_blocks(A52ThreadContext *tctx)
         for (ch = 0; ch < ctx->n_channels; ch++)
             bitwriter_writebits(bw, 1, block->dithflag[ch]);
         if (ctx->params.dynrng_profile == DYNRNG_PROFILE_NONE) {
-            bitwriter_writebits(bw, 1, 0); // no dynamic range
-            if (ctx->acmod == A52_ACMOD_DUAL_MONO)
-                bitwriter_writebits(bw, 1, 0); // no dynamic range 2
+            // no dynamic range, and no dynamic range 2 for dual mono
+            bitwriter_writebits(bw, 1 + (ctx->acmod == A52_ACMOD_DUAL_MONO), 0);
         } else {
             bitwriter_writebits(bw, 1, 1);
             bitwriter_writebits(bw, 8, block->dynrng);
@@ -856,9 +1018,9 @@ output_audio_blocks(A52ThreadContext *tctx)
             }
         }
         if (block->block_num == 0) {
-            // must define coupling strategy in block 0
-            bitwriter_writebits(bw, 1, 1); // new coupling strategy
-            bitwriter_writebits(bw, 1, 0); // no coupling in use
+            // must define coupling strategy in block 0:
+            // new coupling strategy, no coupling in use
+            bitwriter_writebits(bw, 2, 2);
         } else {
             bitwriter_writebits(bw, 1, 0); // no new coupling strategy
         }
@@ -902,13 +1064,15 @@ output_audio_blocks(A52ThreadContext *tctx)
 
         // bit allocation info
         baie = (block->block_num == 0);
-        bitwriter_writebits(bw, 1, baie);
         if (baie) {
-            bitwriter_writebits(bw, 2, frame->sdecaycod);
-            bitwriter_writebits(bw, 2, frame->fdecaycod);
-            bitwriter_writebits(bw, 2, frame->sgaincod);
-            bitwriter_writebits(bw, 2, frame->dbkneecod);
-            bitwriter_writebits(bw, 3, frame->floorcod);
+            bitwriter_writebits(bw, 12, (1 << 11) |
+                                (frame->sdecaycod << 9) |
+                                (frame->fdecaycod << 7) |
+                                (frame->sgaincod  << 5) |
+                                (frame->dbkneecod << 3) |
+                                 frame->floorcod);
+        } else {
+            bitwriter_writebits(bw, 1, 0);
         }
 
         // snr offset
@@ -921,33 +1085,11 @@ output_audio_blocks(A52ThreadContext *tctx)
             }
         }
 
-        bitwriter_writebits(bw, 1, 0); // no delta bit allocation
-        bitwriter_writebits(bw, 1, 0); // no data to skip
+        // no delta bit allocation, no data to skip
+        bitwriter_writebits(bw, 2, 0);
 
         // mantissas
-        for (ch = 0; ch < ctx->n_all_channels; ch++) {
-            int b, q;
-            for (i = 0; i < frame->ncoefs[ch]; i++) {
-                q = block->qmant[ch][i];
-                b = block->bap[ch][i];
-                switch (b) {
-                    case 0:  break;
-                    case 1:  if(q != 128) bitwriter_writebits(bw, 5, q);
-                             break;
-                    case 2:  if(q != 128) bitwriter_writebits(bw, 7, q);
-                             break;
-                    case 3:  bitwriter_writebits(bw, 3, q);
-                             break;
-                    case 4:  if(q != 128) bitwriter_writebits(bw, 7, q);
-                             break;
-                    case 14: bitwriter_writebits(bw, 14, q);
-                             break;
-                    case 15: bitwriter_writebits(bw, 16, q);
-                             break;
-                    default: bitwriter_writebits(bw, b - 1, q);
-                }
-            }
-        }
+        a52_output_mantissas(tctx, block);
     }
 }
 
@@ -996,115 +1138,114 @@ copy_samples(A52ThreadContext *tctx)
 {
     A52Context *ctx = tctx->ctx;
     A52Frame *frame = &tctx->frame;
-    FLOAT buffer[A52_SAMPLES_PER_FRAME];
-    FLOAT *in_audio;
-    FLOAT *out_audio;
-    FLOAT *temp;
-    int ch, blk;
-#define SWAP_BUFFERS temp=in_audio;in_audio=out_audio;out_audio=temp;
+    const FilterChainModel *m;
+    FLOAT z[A52_MAX_CHANNELS][FILTER_CHAIN_STATE_SIZE];
+    FLOAT state[A52_MAX_CHANNELS][FILTER_CHAIN_STATE_SIZE];
+    FLOAT next_state[A52_MAX_CHANNELS][FILTER_CHAIN_STATE_SIZE];
+    FLOAT *st[A52_MAX_CHANNELS], *in[A52_MAX_CHANNELS];
+    FLOAT *out[A52_MAX_CHANNELS], *tap[A52_MAX_CHANNELS];
+    int bs = ctx->params.use_block_switching;
+    int ch;
 
+    // The first half of block 0 is the end of the previous frame, which is
+    // filtered again here.  Its filter state is found from the state the
+    // previous frame started with, using a linear model of the filter chain
+    // over one frame.  Only that small update has to wait for the previous
+    // frame; the filtering itself runs in parallel with other frames.
+    if (ctx->use_filter_chain) {
+        for (ch = 0; ch < ctx->n_all_channels; ch++) {
+            m = &ctx->chain_model[ch >= ctx->n_channels];
+            memset(z[ch], 0, sizeof(z[ch]));
+            filter_chain_model_input(m, tctx->prev_samples[ch], 0, 256, z[ch]);
+            filter_chain_model_input(m, frame->input_audio[ch], 256,
+                                     A52_SAMPLES_PER_FRAME - 256, z[ch]);
+        }
 #ifndef NO_THREADS
-    if (ctx->n_threads > 1) {
-        posix_mutex_lock(&ctx->ts.samples_mutex);
+        if (ctx->n_threads > 1) {
+            posix_mutex_lock(&ctx->ts.samples_mutex);
 
-        windows_cs_enter(&ctx->ts.samples_cs);
+            windows_cs_enter(&ctx->ts.samples_cs);
 
-        while (ctx->ts.samples_thread_num != tctx->thread_num) {
-            posix_cond_wait(&tctx->ts.samples_cond, &ctx->ts.samples_mutex);
+            while (ctx->ts.samples_thread_num != tctx->thread_num) {
+                posix_cond_wait(&tctx->ts.samples_cond, &ctx->ts.samples_mutex);
 
-            windows_cs_leave(&ctx->ts.samples_cs);
-            windows_event_wait(&tctx->ts.samples_event);
-            windows_cs_enter(&ctx->ts.samples_cs);
+                windows_cs_leave(&ctx->ts.samples_cs);
+                windows_event_wait(&tctx->ts.samples_event);
+                windows_cs_enter(&ctx->ts.samples_cs);
+            }
+            windows_event_reset(&tctx->ts.samples_event);
         }
-        windows_event_reset(&tctx->ts.samples_event);
-    }
 #endif
-    for (ch = 0; ch < ctx->n_all_channels; ch++) {
-        out_audio = buffer;
-        in_audio = frame->input_audio[ch];
-        // DC-removal high-pass filter
-        if (ctx->params.use_dc_filter) {
-            filter_run(&ctx->dc_filter[ch], out_audio, in_audio,
-                       A52_SAMPLES_PER_FRAME);
-            SWAP_BUFFERS
-        }
-        if (ch < ctx->n_channels) {
-            // channel bandwidth filter
-            if (ctx->params.use_bw_filter) {
-                filter_run(&ctx->bw_filter[ch], out_audio, in_audio,
-                           A52_SAMPLES_PER_FRAME);
-                SWAP_BUFFERS
-            }
-            // block-switching high-pass filter
-            if (ctx->params.use_block_switching) {
-                filter_run(&ctx->bs_filter[ch], out_audio, in_audio,
-                           A52_SAMPLES_PER_FRAME);
-                memcpy(frame->blocks[0].transient_samples[ch],
-                       ctx->last_transient_samples[ch], 256 * sizeof(FLOAT));
-                memcpy(&frame->blocks[0].transient_samples[ch][256], out_audio,
-                       256 * sizeof(FLOAT));
-                for (blk = 1; blk < A52_NUM_BLOCKS; blk++) {
-                    memcpy(frame->blocks[blk].transient_samples[ch],
-                           &out_audio[256*(blk-1)], 512 * sizeof(FLOAT));
-                }
-                memcpy(ctx->last_transient_samples[ch],
-                       &out_audio[256*5], 256 * sizeof(FLOAT));
-            }
-        } else {
-            // LFE bandwidth low-pass filter
-            if (ctx->params.use_lfe_filter) {
-                assert(ch == ctx->lfe_channel);
-                filter_run(&ctx->lfe_filter, out_audio, in_audio,
-                           A52_SAMPLES_PER_FRAME);
-                SWAP_BUFFERS
-            }
+        for (ch = 0; ch < ctx->n_all_channels; ch++) {
+            m = &ctx->chain_model[ch >= ctx->n_channels];
+            memcpy(state[ch], ctx->filter_state[ch], sizeof(state[ch]));
+            filter_chain_model_advance(m, ctx->filter_state[ch], z[ch]);
+            memcpy(next_state[ch], ctx->filter_state[ch], sizeof(next_state[ch]));
         }
+#ifndef NO_THREADS
+        if (ctx->n_threads > 1) {
+            ++ctx->ts.samples_thread_num;
+            ctx->ts.samples_thread_num %= ctx->n_threads;
 
-        memcpy(frame->blocks[0].input_samples[ch], ctx->last_samples[ch],
-               256 * sizeof(FLOAT));
-        memcpy(&frame->blocks[0].input_samples[ch][256], in_audio,
-               256 * sizeof(FLOAT));
-        for (blk = 1; blk < A52_NUM_BLOCKS; blk++) {
-            memcpy(frame->blocks[blk].input_samples[ch], &in_audio[256*(blk-1)],
-                   512 * sizeof(FLOAT));
+            posix_cond_signal(tctx->ts.next_samples_cond);
+            posix_mutex_unlock(&ctx->ts.samples_mutex);
+
+            windows_event_set(tctx->ts.next_samples_event);
+            windows_cs_leave(&ctx->ts.samples_cs);
         }
-        memcpy(ctx->last_samples[ch],
-               &in_audio[256*5], 256 * sizeof(FLOAT));
+#endif
     }
-#ifndef NO_THREADS
-    if (ctx->n_threads > 1) {
-        ++ctx->ts.samples_thread_num;
-        ctx->ts.samples_thread_num %= ctx->n_threads;
-
-        posix_cond_signal(tctx->ts.next_samples_cond);
-        posix_mutex_unlock(&ctx->ts.samples_mutex);
 
-        windows_event_set(tctx->ts.next_samples_event);
-        windows_cs_leave(&ctx->ts.samples_cs);
+    // The blocks are views of the filtered audio, which starts with the
+    // previous frame's last 256 samples.  The frame's own samples are
+    // already in place after those and are filtered in place.  Its last 256
+    // samples start from the modelled state, exactly like the next frame will.
+    for (ch = 0; ch < ctx->n_all_channels; ch++) {
+        st[ch] = state[ch];
+        in[ch] = tctx->prev_samples[ch];
+        out[ch] = frame->filtered_audio[ch];
+        tap[ch] = frame->transient_audio[ch];
     }
-#endif
-#undef SWAP_BUFFERS
+    filter_run_chain(ctx->filter_chain, ctx->n_all_channels, st, in, out,
+                     bs ? tap : NULL, 256);
+    for (ch = 0; ch < ctx->n_all_channels; ch++) {
+        in[ch] = out[ch] = frame->input_audio[ch];
+        tap[ch] = bs ? &frame->transient_audio[ch][256] : NULL;
+    }
+    filter_run_chain(ctx->filter_chain, ctx->n_all_channels, st, in, out,
+                     bs ? tap : NULL, A52_SAMPLES_PER_FRAME - 256);
+    for (ch = 0; ch < ctx->n_all_channels; ch++) {
+        st[ch] = next_state[ch];
+        in[ch] = out[ch] = &frame->input_audio[ch][A52_SAMPLES_PER_FRAME - 256];
+        tap[ch] = bs ? &frame->transient_audio[ch][A52_SAMPLES_PER_FRAME] : NULL;
+    }
+    filter_run_chain(ctx->filter_chain, ctx->n_all_channels, st, in, out,
+                     bs ? tap : NULL, 256);
 }
 
-/* determines block length by detecting transients */
+/**
+ * determines block length by detecting transients
+ * @param peak  peak level of each 64-sample segment of the block
+ */
 static int
-detect_transient(FLOAT *in)
+detect_transient(const FLOAT *peak)
 {
-    FLOAT *xx = in;
-    int i, j;
+    int i;
     FLOAT level1[2];
     FLOAT level2[4];
-    FLOAT level3[8];
     FLOAT tmax = FCONST(100.0) / FCONST(32768.0);
     FLOAT t1 = FCONST(0.100);
     FLOAT t2 = FCONST(0.075);
     FLOAT t3 = FCONST(0.050);
 
+    // the longer segments' peaks follow from the 64-sample ones
+    for (i = 0; i < 4; i++)
+        level2[i] = MAX(peak[2*i], peak[2*i+1]);
+    for (i = 0; i < 2; i++)
+        level1[i] = MAX(level2[2*i], level2[2*i+1]);
+
     // level 1 (2 x 256)
     for (i = 0; i < 2; i++) {
-        level1[i] = 0;
-        for (j = 0; j < 256; j++)
-            level1[i] = MAX(AFT_FABS(xx[i*256+j]), level1[i]);
         if (level1[i] < tmax)
             return 0;
         if ((i > 0) && (level1[i] * t1 > level1[i-1]))
@@ -1112,20 +1253,14 @@ detect_transient(FLOAT *in)
     }
 
     // level 2 (4 x 128)
-    for (i = 1; i < 4; i++) {
-        level2[i] = 0;
-        for (j = 0; j < 128; j++)
-            level2[i] = MAX(AFT_FABS(xx[i*128+j]), level2[i]);
-        if ((i > 1) && (level2[i] * t2 > level2[i-1]))
+    for (i = 2; i < 4; i++) {
+        if (level2[i] * t2 > level2[i-1])
             return 1;
     }
 
     // level 3 (8 x 64)
-    for (i = 3; i < 8; i++) {
-        level3[i] = 0;
-        for (j = 0; j < 64; j++)
-            level3[i] = MAX(AFT_FABS(xx[i*64+j]), level3[i]);
-        if ((i > 3) && (level3[i] * t3 > level3[i-1]))
+    for (i = 4; i < 8; i++) {
+        if (peak[i] * t3 > peak[i-1])
             return 1;
     }
 
@@ -1141,20 +1276,27 @@ generate_coefs(A52ThreadContext *tctx)
         ctx->mdct_ctx_256.mdct;
     void (*mdct_512)(struct A52ThreadContext *tctx, FLOAT *out, FLOAT *in) =
         ctx->mdct_ctx_512.mdct;
+    FLOAT *win = tctx->mdct_tctx_512.buffer1;
+    FLOAT peaks[(256 + A52_SAMPLES_PER_FRAME) / 64];
     int blk, ch, i;
 
     for (ch = 0; ch < ctx->n_all_channels; ch++) {
+        // blocks overlap by half, so the 64-sample peaks of the whole
+        // transient-detect signal are found once and shared between blocks
+        if (ctx->params.use_block_switching)
+            filter_peaks(tctx->frame.transient_audio[ch], peaks, 4 * (A52_NUM_BLOCKS + 1), 64);
         for (blk = 0; blk < A52_NUM_BLOCKS; blk++) {
             block = &tctx->frame.blocks[blk];
             if (ctx->params.use_block_switching)
-                block->blksw[ch] = detect_transient(block->transient_samples[ch]);
+                block->blksw[ch] = detect_transient(&peaks[4*blk]);
             else
                 block->blksw[ch] = 0;
-            ctx->winf.apply_a52_window(block->input_samples[ch]);
+            // blocks overlap, so they are windowed into a scratch buffer
+            ctx->winf.apply_a52_window(win, block->input_samples[ch]);
             if (block->blksw[ch])
-                mdct_256(tctx, block->mdct_coef[ch], block->input_samples[ch]);
+                mdct_256(tctx, block->mdct_coef[ch], win);
             else
-                mdct_512(tctx, block->mdct_coef[ch], block->input_samples[ch]);
+                mdct_512(tctx, block->mdct_coef[ch], win);
             for (i = tctx->frame.ncoefs[ch]; i < 256; i++)
                 block->mdct_coef[ch][i] = 0.0;
         }
@@ -1291,11 +1433,14 @@ begin_encode_frame(A52ThreadContext *tctx)
     return 0;
 }
 
+/**
+ * Runs the frame encoding stages up to exponent coding.  In ABR mode, this
+ * is also where the frame's bit demand is estimated.
+ */
 static int
-process_frame(A52ThreadContext *tctx, uint8_t *output_frame_buffer)
+process_frame_analysis(A52ThreadContext *tctx)
 {
     A52Context *ctx = tctx->ctx;
-    A52Frame *frame = &tctx->frame;
 
     if (frame_init(tctx)) {
         fprintf(stderr, "Encoding has not properly initialized\n");
@@ -1310,15 +1455,30 @@ process_frame(A52ThreadContext *tctx, uint8_t *output_frame_buffer)
     if (ctx->acmod == A52_ACMOD_STEREO)
         calc_rematrixing(tctx);
 
+    a52_process_exponents(tctx);
+
     // variable bandwidth
     if (ctx->params.bwcode == -2) {
-        // process exponents at full bandwidth
-        a52_process_exponents(tctx);
-        // run bit allocation at q=240 to calculate bandwidth
+        // estimate bandwidth at q=240 from the full bandwidth exponents,
+        // then regroup the exponents for the chosen bandwidth
         vbw_bit_allocation(tctx);
+        a52_group_exponents(tctx);
     }
 
-    a52_process_exponents(tctx);
+    if (ctx->params.encoding_mode == AFTEN_ENC_MODE_ABR)
+        abr_estimate_bits(tctx);
+
+    return 0;
+}
+
+/**
+ * Runs bit allocation and quantization, and writes the frame.
+ */
+static int
+process_frame_coding(A52ThreadContext *tctx, uint8_t *output_frame_buffer)
+{
+    A52Context *ctx = tctx->ctx;
+    A52Frame *frame = &tctx->frame;
 
     if (ctx->params.encoding_mode == AFTEN_ENC_MODE_CBR)
         adjust_frame_size(tctx);
@@ -1329,8 +1489,6 @@ process_frame(A52ThreadContext *tctx, uint8_t *output_frame_buffer)
         return -1;
     }
 
-    quantize_mantissas(tctx);
-
     // increment counters
     tctx->bit_cnt += frame->frame_size * 16;
     tctx->sample_cnt += A52_SAMPLES_PER_FRAME;
@@ -1339,6 +1497,7 @@ process_frame(A52ThreadContext *tctx, uint8_t *output_frame_buffer)
     tctx->status.quality = frame->quality;
     tctx->status.bit_rate = frame->bit_rate;
     tctx->status.bwcode = frame->bwcode;
+    tctx->status.bit_alloc_passes = frame->bit_alloc_passes;
 
     output_frame_header(tctx, output_frame_buffer);
     output_audio_blocks(tctx);
@@ -1347,16 +1506,87 @@ process_frame(A52ThreadContext *tctx, uint8_t *output_frame_buffer)
     return 0;
 }
 
+static int
+process_frame(A52ThreadContext *tctx, uint8_t *output_frame_buffer)
+{
+    if (process_frame_analysis(tctx))
+        return -1;
+
+    return process_frame_coding(tctx, output_frame_buffer);
+}
+
+/**
+ * Encodes a frame in ABR mode.
+ * New input is analyzed and added to the lookahead queue.  The oldest frame
+ * is coded once the queue is full, or once the input has ended while frames
+ * remain queued.  Returns 0 while the queue is filling.
+ */
+static int
+process_frame_abr(AftenContext *s, uint8_t *frame_buffer, const void *samples, int count)
+{
+    A52Context *ctx = s->private_context;
+    A52RateControl *rc = &ctx->rc;
+    A52ThreadContext *tctx;
+
+    // append extra silent frame if final frame is > 1280 samples, to flush 256 samples in mdct
+    if (ctx->last_samples_count > (A52_SAMPLES_PER_FRAME - 256) || ctx->last_samples_count == -1) {
+        tctx = &ctx->tctx[(rc->head + rc->queued) % (rc->lookahead + 1)];
+        convert_samples_from_src(tctx, samples, count);
+        if (process_frame_analysis(tctx))
+            return -1;
+        ctx->last_samples_count = count;
+        if (++rc->queued <= rc->lookahead)
+            return 0;
+    }
+    if (!rc->queued)
+        return 0;
+
+    tctx = &ctx->tctx[rc->head];
+    if (process_frame_coding(tctx, frame_buffer))
+        return -1;
+    rc->head = (rc->head + 1) % (rc->lookahead + 1);
+    rc->queued--;
+
+    s->status.quality   = tctx->status.quality;
+    s->status.bit_rate  = tctx->status.bit_rate;
+    s->status.bwcode    = tctx->status.bwcode;
+    s->status.bit_alloc_passes = tctx->status.bit_alloc_passes;
+
+    return tctx->framesize;
+}
+
 static int
 convert_samples_from_src(A52ThreadContext *tctx, const void *vsrc, int count)
 {
     A52Context *ctx = tctx->ctx;
-    ctx->fmt_convert_from_src(tctx->frame.input_audio, vsrc, ctx->n_all_channels, count);
+    FLOAT *dest[A52_MAX_CHANNELS];
+    int ch;
+
+    if (ctx->planar_input) {
+        const void *const *src = vsrc;
+        // the channel array may be NULL when flushing
+        for (ch = 0; count && ch < ctx->n_all_channels; ch++) {
+            dest[0] = tctx->frame.input_audio[ch];
+            ctx->fmt_convert_channel(dest, src[ctx->channel_src[ch]], 1, count);
+        }
+    } else {
+        // input channel channel_src[ch] lands in A/52 channel ch
+        for (ch = 0; ch < ctx->n_all_channels; ch++)
+            dest[ctx->channel_src[ch]] = tctx->frame.input_audio[ch];
+        ctx->fmt_convert_from_src(dest, vsrc, ctx->n_all_channels, count);
+    }
     if (count < A52_SAMPLES_PER_FRAME) {
-        int ch;
         for (ch = 0; ch < ctx->n_all_channels; ch++)
             memset(&tctx->frame.input_audio[ch][count], 0, (A52_SAMPLES_PER_FRAME - count) * sizeof(FLOAT));
     }
+    // frames are converted in order, so this is where each frame gets the
+    // end of the one before it, which it filters again for its first block
+    for (ch = 0; ch < ctx->n_all_channels; ch++) {
+        memcpy(tctx->prev_samples[ch], ctx->last_samples[ch], 256 * sizeof(FLOAT));
+        memcpy(ctx->last_samples[ch],
+               &tctx->frame.input_audio[ch][A52_SAMPLES_PER_FRAME-256],
+               256 * sizeof(FLOAT));
+    }
     return 0;
 }
 
@@ -1459,6 +1689,7 @@ process_frame_parallel(AftenContext *s, uint8_t *frame_buffer, const void *sampl
                     s->status.quality   = tctx->status.quality;
                     s->status.bit_rate  = tctx->status.bit_rate;
                     s->status.bwcode    = tctx->status.bwcode;
+                    s->status.bit_alloc_passes = tctx->status.bit_alloc_passes;
                 } else {
                     posix_mutex_unlock(&tctx->ts.enter_mutex);
                     goto end;
@@ -1505,26 +1736,22 @@ aften_transcode_frame(AftenContext *s, uint8_t *input_frame_buffer, int input_fr
     s->status.quality   = tctx->status.quality;
     s->status.bit_rate  = tctx->status.bit_rate;
     s->status.bwcode    = tctx->status.bwcode;
+    s->status.bit_alloc_passes = tctx->status.bit_alloc_passes;
 
     return tctx->framesize;
 }
 #endif
 
-int
-aften_encode_frame(AftenContext *s, uint8_t *frame_buffer, const void *samples, int count)
+/**
+ * Encodes one frame from either interleaved or planar samples, as set in
+ * ctx->planar_input.  The samples are always converted on the calling thread.
+ */
+static int
+encode_frame(AftenContext *s, uint8_t *frame_buffer, const void *samples, int count)
 {
-    A52Context *ctx;
+    A52Context *ctx = s->private_context;
     A52ThreadContext *tctx;
 
-    if (s == NULL || frame_buffer == NULL || (samples == NULL && count)) {
-        fprintf(stderr, "One or more NULL parameters passed to aften_encode_frame\n");
-        return -1;
-    }
-    if (count > A52_SAMPLES_PER_FRAME || count < 0) {
-        fprintf(stderr, "Invalid count passed to aften_encode_frame\n");
-        return -1;
-    }
-    ctx = s->private_context;
     if (count && ctx->last_samples_count != -1 && ctx->last_samples_count < A52_SAMPLES_PER_FRAME) {
         fprintf(stderr, "count must be 0 after having once been <A52_SAMPLES_PER_FRAME when passed to aften_encode_frame\n");
         return -1;
@@ -1536,6 +1763,9 @@ aften_encode_frame(AftenContext *s, uint8_t *frame_buffer, const void *samples,
         return process_frame_parallel(s, frame_buffer, samples, count, &info);
     }
 #endif
+    if (ctx->params.encoding_mode == AFTEN_ENC_MODE_ABR)
+        return process_frame_abr(s, frame_buffer, samples, count);
+
     // append extra silent frame if final frame is > 1280 samples, to flush 256 samples in mdct
     if (ctx->last_samples_count <= (A52_SAMPLES_PER_FRAME - 256) && ctx->last_samples_count != -1)
         return 0;
@@ -1549,14 +1779,60 @@ aften_encode_frame(AftenContext *s, uint8_t *frame_buffer, const void *samples,
     s->status.quality   = tctx->status.quality;
     s->status.bit_rate  = tctx->status.bit_rate;
     s->status.bwcode    = tctx->status.bwcode;
+    s->status.bit_alloc_passes = tctx->status.bit_alloc_passes;
 
     return tctx->framesize;
 }
 
 int
-aften_encode_close(AftenContext *s)
+aften_encode_frame(AftenContext *s, uint8_t *frame_buffer, const void *samples, int count)
 {
+    A52Context *ctx;
+
+    if (s == NULL || frame_buffer == NULL || (samples == NULL && count)) {
+        fprintf(stderr, "One or more NULL parameters passed to aften_encode_frame\n");
+        return -1;
+    }
+    if (count > A52_SAMPLES_PER_FRAME || count < 0) {
+        fprintf(stderr, "Invalid count passed to aften_encode_frame\n");
+        return -1;
+    }
+    ctx = s->private_context;
+    ctx->planar_input = 0;
+    return encode_frame(s, frame_buffer, samples, count);
+}
+
+int
+aften_encode_frame_planar(AftenContext *s, uint8_t *frame_buffer,
+                          const void *const *samples, int count)
+{
+    A52Context *ctx;
     int ch;
+
+    if (s == NULL || frame_buffer == NULL || (samples == NULL && count)) {
+        fprintf(stderr, "One or more NULL parameters passed to aften_encode_frame_planar\n");
+        return -1;
+    }
+    if (count > A52_SAMPLES_PER_FRAME || count < 0) {
+        fprintf(stderr, "Invalid count passed to aften_encode_frame_planar\n");
+        return -1;
+    }
+    ctx = s->private_context;
+    if (count) {
+        for (ch = 0; ch < ctx->n_all_channels; ch++) {
+            if (samples[ch] == NULL) {
+                fprintf(stderr, "NULL channel passed to aften_encode_frame_planar\n");
+                return -1;
+            }
+        }
+    }
+    ctx->planar_input = 1;
+    return encode_frame(s, frame_buffer, samples, count);
+}
+
+int
+aften_encode_close(AftenContext *s)
+{
     int ret_val = 0;
 
     if (s != NULL && s->private_context != NULL) {
@@ -1572,14 +1848,11 @@ aften_encode_close(AftenContext *s)
         }
 #endif
         if (ctx->tctx) {
-            if (ctx->n_threads == 1)
-                mdct_thread_close(&ctx->tctx[0]);
-            else {
+            if (ctx->n_threads > 1) {
                 int i;
                 for (i = 0; i < ctx->n_threads; i++) {
                     A52ThreadContext *cur_tctx = ctx->tctx + i;
                     thread_join(cur_tctx->ts.thread);
-                    mdct_thread_close(cur_tctx);
                     posix_cond_destroy(&cur_tctx->ts.enter_cond);
                     posix_cond_destroy(&cur_tctx->ts.confirm_cond);
                     posix_cond_destroy(&cur_tctx->ts.samples_cond);
@@ -1599,23 +1872,12 @@ aften_encode_close(AftenContext *s)
                 for (i = 0; i < ctx->n_threads; i++) {
                     A52ThreadContext *cur_tctx = ctx->tctx + i;
                     a52_decode_deinit_thread(cur_tctx);
-                    free(cur_tctx->dctx);
                 }
             }
-            free(ctx->tctx);
-        }
-        // mdct_close deinits both mdcts
-        mdct_close(ctx);
-
-        // close input filters
-        filter_close(&ctx->lfe_filter);
-        for (ch = 0; ch < A52_MAX_CHANNELS; ch++) {
-            filter_close(&ctx->bs_filter[ch]);
-            filter_close(&ctx->dc_filter[ch]);
-            filter_close(&ctx->bw_filter[ch]);
         }
 
-        free(ctx);
+        // releases the context itself along with everything else
+        mem_arena_destroy(ctx->arena);
         s->private_context = NULL;
     }
 
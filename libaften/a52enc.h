@@ -35,7 +35,9 @@
 #include "aften.h"
 #include "exponent.h"
 #include "filter.h"
+#include "mem.h"
 #include "mdct.h"
+#include "quantize.h"
 #include "threading.h"
 #include "window.h"
 #include "a52dec.h"
@@ -55,17 +57,37 @@ typedef struct A52ThreadContext {
     A52Frame frame;
     BitWriter bw;
     uint8_t frame_buffer[A52_MAX_CODED_FRAME_SIZE];
+    FLOAT prev_samples[A52_MAX_CHANNELS][256];  ///< unfiltered end of the previous frame
 
     uint32_t bit_cnt;
     uint32_t sample_cnt;
 
-    int last_quality;
+    int snr_prediction;
+    int snr_prediction_error;
 
     MDCTThreadContext mdct_tctx_512;
     MDCTThreadContext mdct_tctx_256;
 } A52ThreadContext;
 
+/**
+ * Average bitrate rate control state.
+ * Analyzed frames wait in a ring of thread contexts until the rate control
+ * has seen the bit demand of the following frames.  The reservoir fill and
+ * the per-frame target are in units of bits * sample_rate so fractional
+ * frame sizes do not accumulate rounding error.
+ */
+typedef struct A52RateControl {
+    int lookahead;      ///< number of frames queued ahead of the coded frame
+    int head;           ///< ring index of the next frame to be coded
+    int queued;         ///< number of analyzed frames waiting to be coded
+    int quality;        ///< snroffset around which demand is estimated
+    int64_t target;     ///< average bits per frame
+    int64_t size;       ///< reservoir capacity
+    int64_t fill;       ///< current reservoir fill
+} A52RateControl;
+
 typedef struct A52Context {
+    MemArena *arena;            ///< holds this context and all encoder memory
     A52ThreadContext *tctx;
 #ifndef NO_THREADS
     A52GlobalThreadSync ts;
@@ -74,10 +96,12 @@ typedef struct A52Context {
     int (*begin_process_frame)(A52ThreadContext *tctx);
     AftenEncParams params;
     AftenMetadata meta;
-    void (*fmt_convert_from_src)(FLOAT dest[A52_MAX_CHANNELS][A52_SAMPLES_PER_FRAME],
-          const void *vsrc, int nch, int n);
+    void (*fmt_convert_from_src)(FLOAT **dest, const void *vsrc, int nch, int n);
+    void (*fmt_convert_channel)(FLOAT **dest, const void *vsrc, int nch, int n);
+    int planar_input;           ///< samples of the current call are planar
     A52WindowFunctions winf;
     A52ExponentFunctions expf;
+    A52QuantizeFunctions quantf;
 
     int n_threads;
     int last_samples_count;
@@ -86,6 +110,7 @@ typedef struct A52Context {
     int acmod;
     int lfe;
     int lfe_channel;
+    int channel_src[A52_MAX_CHANNELS]; ///< input channel of each A/52 channel
     int sample_rate;
     int halfratecod;
     int bsid;
@@ -94,14 +119,23 @@ typedef struct A52Context {
     int target_bitrate;
     int frmsizecod;
     int fixed_bwcode;
+    A52RateControl rc;
+
+    uint8_t header_template[16];    ///< frame header with frmsizecod=0
+    int header_bits;                ///< bits in header_template
+    int frame_bits_const;           ///< side info bits which are the same in every frame
 
     FilterContext bs_filter[A52_MAX_CHANNELS];
     FilterContext dc_filter[A52_MAX_CHANNELS];
     FilterContext bw_filter[A52_MAX_CHANNELS];
     FilterContext lfe_filter;
+    FilterChain filter_chain[A52_MAX_CHANNELS];
+    FilterChainModel chain_model[2];    ///< full bandwidth and LFE chains over one frame
+    int use_filter_chain;
 
-    FLOAT last_samples[A52_MAX_CHANNELS][A52_SAMPLES_PER_FRAME]; // 256 would be enough, but want to use converting functions
-    FLOAT last_transient_samples[A52_MAX_CHANNELS][256];
+    /** input filter state before the last 256 samples of the latest frame */
+    FLOAT filter_state[A52_MAX_CHANNELS][FILTER_CHAIN_STATE_SIZE];
+    FLOAT last_samples[A52_MAX_CHANNELS][256];  ///< unfiltered end of the latest frame
 
     MDCTContext mdct_ctx_512;
     MDCTContext mdct_ctx_256;
@@ -81,6 +81,22 @@ const uint8_t a52_channels_tab[8] = {
     2, 1, 2, 3, 3, 4, 4, 5
 };
 
+/**
+ * Table to remap channels from WAV order to A/52 order.
+ * A/52 channel ch is input channel a52_wav_chmap[acmod][lfe][ch].
+ * note: thanks to Tebasuna for help in getting this order right.
+ */
+const uint8_t a52_wav_chmap[8][2][6] = {
+    { { 0, 1,          }, { 0, 1, 2,         } },
+    { { 0,             }, { 0, 1,            } },
+    { { 0, 1,          }, { 0, 1, 2,         } },
+    { { 0, 2, 1,       }, { 0, 2, 1, 3,      } },
+    { { 0, 1, 2,       }, { 0, 1, 3, 2,      } },
+    { { 0, 2, 1, 3,    }, { 0, 2, 1, 4, 3,   } },
+    { { 0, 1, 2, 3, 4, }, { 0, 1, 3, 4, 2,   } },
+    { { 0, 2, 1, 3, 4, }, { 0, 2, 1, 4, 5, 3 } },
+};
+
 /* possible frequencies */
 const uint16_t a52_sample_rate_tab[3] = { 48000, 44100, 32000 };
 
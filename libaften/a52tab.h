@@ -27,6 +27,7 @@
 
 extern const uint16_t a52_frame_size_tab[38][3];
 extern const uint8_t  a52_channels_tab[8];
+extern const uint8_t  a52_wav_chmap[8][2][6];
 extern const uint16_t a52_sample_rate_tab[3];
 extern const uint16_t a52_bitrate_tab[19];
 extern const uint8_t  a52_log_add_tab[260];
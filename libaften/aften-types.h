@@ -54,7 +54,8 @@ typedef enum {
  */
 typedef enum {
     AFTEN_ENC_MODE_CBR = 0,
-    AFTEN_ENC_MODE_VBR
+    AFTEN_ENC_MODE_VBR,
+    AFTEN_ENC_MODE_ABR
 } AftenEncMode;
 
 /**
@@ -79,6 +80,16 @@ typedef enum {
     A52_SAMPLE_FMT_S8
 } A52SampleFormat;
 
+/**
+ * Channel order of the input samples
+ */
+typedef enum {
+    AFTEN_CH_ORDER_A52 = 0,
+    AFTEN_CH_ORDER_WAV,
+    AFTEN_CH_ORDER_MPEG,
+    AFTEN_CH_ORDER_CUSTOM
+} AftenChannelOrder;
+
 /**
  * Dynamic Range Profiles
  */
@@ -118,6 +129,7 @@ typedef struct {
     int amd_3dnowext;
     int amd_sse_mmx;
     int altivec;
+    int pclmul;
 } AftenSimdInstructions;
 
 /**
@@ -141,6 +153,15 @@ typedef struct {
      * Wanted SIMD instruction sets
      */
     AftenSimdInstructions wanted_simd_instructions;
+
+    /**
+     * Huge pages option.
+     * All encoder memory is allocated from one arena.  Set to 1 to ask for
+     * the arena to be backed by transparent huge pages where the system
+     * supports them, 0 for normal pages.
+     * default is 0
+     */
+    int use_huge_pages;
 } AftenSystemParams;
 
 /**
@@ -151,6 +172,7 @@ typedef struct {
      * Bitrate selection mode.
      * AFTEN_ENC_MODE_CBR : constant bitrate
      * AFTEN_ENC_MODE_VBR : variable bitrate
+     * AFTEN_ENC_MODE_ABR : average bitrate
      * default is CBR
      */
     AftenEncMode encoding_mode;
@@ -202,6 +224,8 @@ typedef struct {
      * default is 0
      * For CBR mode, this selects bitrate based on the number of channels.
      * For VBR mode, this sets the maximum bitrate to 640 kbps.
+     * For ABR mode, this sets the average bitrate. Any value within the range
+     * of valid bitrates may be used, and 0 selects the same default as CBR.
      */
     int bitrate;
 
@@ -273,6 +297,17 @@ typedef struct {
      */
     int max_bwcode;
 
+    /**
+     * ABR lookahead.
+     * For use with average bitrate mode, this option sets the number of
+     * frames analyzed ahead of the frame being encoded.  Output is delayed by
+     * this many frames.  The bit reservoir holds one more frame than the
+     * lookahead at the average bitrate.
+     * minimum is 1, maximum is 32
+     * default is 8.
+     */
+    int abr_lookahead;
+
 } AftenEncParams;
 
 /**
@@ -332,6 +367,9 @@ typedef struct {
     int quality;
     int bit_rate;
     int bwcode;
+
+    /** Number of bit allocation passes used to encode the frame */
+    int bit_alloc_passes;
 } AftenStatus;
 
 /**
@@ -382,12 +420,34 @@ typedef struct {
      */
     A52SampleFormat sample_format;
 
+    /**
+     * Channel order of the input samples
+     * The encoder puts the channels in A/52 order while converting the
+     * input, so the samples do not need to be remapped beforehand.
+     * AFTEN_CH_ORDER_A52  : already in A/52 order
+     * AFTEN_CH_ORDER_WAV  : default WAV order, see aften_remap_wav_to_a52
+     * AFTEN_CH_ORDER_MPEG : MPEG order, see aften_remap_mpeg_to_a52
+     * AFTEN_CH_ORDER_CUSTOM : order given by channel_map
+     * default: AFTEN_CH_ORDER_A52
+     */
+    AftenChannelOrder channel_order;
+
+    /**
+     * Custom channel order
+     * For AFTEN_CH_ORDER_CUSTOM, A/52 channel i is taken from input channel
+     * channel_map[i].  The first 'channels' entries must be a permutation of
+     * 0 to channels-1.
+     */
+    int channel_map[6];
+
     /**
      * Initial samples
      * To prevent padding und thus to get perfect sync,
      * exactly 256 samples/channel can be provided here.
      * This is not recommended, as without padding these samples can't be properly
      * reconstructed anymore.
+     * The samples must be interleaved, also when aften_encode_frame_planar is
+     * used for the frames.
      */
     void* initial_samples;
 
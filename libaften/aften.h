@@ -87,6 +87,27 @@ AFTEN_API int aften_encode_init(AftenContext *s);
 AFTEN_API int aften_encode_frame(AftenContext *s, unsigned char *frame_buffer,
                                  const void *samples, int count);
 
+/**
+ * Encodes a single AC-3 frame from planar (non-interleaved) samples.
+ * The samples are converted straight into the encoder's planar buffers, and
+ * input in the native FLOAT type (see aften_get_float_type) is copied as is.
+ * There is no planar form of AftenContext.initial_samples.  It is always read
+ * as interleaved samples by aften_encode_init, even if every frame is then
+ * encoded with this function, so a planar caller must interleave those 256
+ * samples per channel itself.
+ * @param s    The encoding context
+ * @param[out] frame_buffer Pointer to output frame data
+ * @param[in]  samples      Array of one pointer per input channel, each
+ * pointing to @p count samples of the context's sample_format
+ * @param[in]  count        Number of input audio samples (per channel);
+ * same rules as for @c aften_encode_frame
+ * @return Returns the number of bytes written to @p frame_buffer, or returns
+ * a negative value on error.
+ */
+AFTEN_API int aften_encode_frame_planar(AftenContext *s,
+                                        unsigned char *frame_buffer,
+                                        const void *const *samples, int count);
+
 /**
  * Sets the parameters in the context @p s to their default values.
  * @param s The encoding context
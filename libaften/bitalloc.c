@@ -29,6 +29,21 @@
 #include "a52enc.h"
 #include "bitalloc.h"
 
+/** snroffset distance between the 2 ABR demand estimates */
+#define ABR_EST_STEP 32
+
+/** estimated number of bits used for a mantissa, indexed by bap value. */
+static FLOAT mant_est_tab[16] = {
+    FCONST( 0.000), FCONST( 1.667),
+    FCONST( 2.333), FCONST( 3.000),
+    FCONST( 3.500), FCONST( 4.000),
+    FCONST( 5.000), FCONST( 6.000),
+    FCONST( 7.000), FCONST( 8.000),
+    FCONST( 9.000), FCONST(10.000),
+    FCONST(11.000), FCONST(12.000),
+    FCONST(14.000), FCONST(16.000)
+};
+
 /**
  * A52 bit allocation preparation to speed up matching left bits.
  * This generates the power-spectral densities and the masking curve based on
@@ -128,6 +143,8 @@ bit_alloc(A52ThreadContext *tctx, int snroffst)
     int blk, ch;
     int bits;
 
+    frame->bit_alloc_passes++;
+
     bits = 0;
     snroffst = (snroffst << 2) - 960;
 
@@ -159,30 +176,21 @@ bit_alloc(A52ThreadContext *tctx, int snroffst)
     return bits;
 }
 
-/** Counts all frame bits except for mantissas and exponents */
-static void
-count_frame_bits(A52ThreadContext *tctx)
+/**
+ * Counts the frame bits which do not change from frame to frame: the frame
+ * header, the fixed-size side info in each block, the aux/crc flags and the
+ * CRC.  Must be called after the header template has been rendered.
+ */
+void
+count_const_frame_bits(A52Context *ctx)
 {
-    static int frame_bits_inc[8] = { 8, 0, 2, 2, 2, 4, 2, 4 };
-    A52Context *ctx = tctx->ctx;
-    A52Frame *frame = &tctx->frame;
-    A52Block *block;
-    int blk, ch;
-    int frame_bits;
-
-    frame_bits = 0;
+    int blk, frame_bits;
 
     // header size
-    frame_bits += 65;
-    frame_bits += frame_bits_inc[ctx->acmod];
-    if (ctx->meta.xbsi1e)
-        frame_bits += 14;
-    if (ctx->meta.xbsi2e)
-        frame_bits += 14;
+    frame_bits = ctx->header_bits;
 
     // audio blocks
     for (blk = 0; blk < A52_NUM_BLOCKS; blk++) {
-        block = &frame->blocks[blk];
         frame_bits += ctx->n_channels; // blksw
         frame_bits += ctx->n_channels; // dithflg
         frame_bits += 1 + (ctx->acmod == A52_ACMOD_DUAL_MONO); // dynrnge, dynrng2e
@@ -203,23 +211,12 @@ count_frame_bits(A52ThreadContext *tctx)
         frame_bits += 2 * ctx->n_channels; // chexpstr
         if (ctx->lfe)
             frame_bits++; // lfeexpstr
-        for (ch = 0; ch < ctx->n_channels; ch++) {
-            if (block->exp_strategy[ch] != EXP_REUSE) {
-                frame_bits += 6; // chbwcod
-                frame_bits += 2; // gainrng
-            }
-        }
         frame_bits++; // baie
         if (!blk) {
             // sdcycod[2], fdcycod[2], sgaincod[2], dbpbcod[2], floorcod[3]
             frame_bits += 2 + 2 + 2 + 2 + 3;
         }
         frame_bits++; // snr
-        if (block->write_snr) {
-            frame_bits += 6; // csnroffset
-            frame_bits += ctx->n_all_channels * 4; // fsnroffset
-            frame_bits += ctx->n_all_channels * 3; // fgaincod
-        }
         frame_bits++; // delta
         frame_bits++; // skip
     }
@@ -230,9 +227,118 @@ count_frame_bits(A52ThreadContext *tctx)
     // CRC
     frame_bits += 16;
 
+    ctx->frame_bits_const = frame_bits;
+}
+
+/** Counts all frame bits except for mantissas and exponents */
+static void
+count_frame_bits(A52ThreadContext *tctx)
+{
+    A52Context *ctx = tctx->ctx;
+    A52Frame *frame = &tctx->frame;
+    A52Block *block;
+    int blk, ch;
+    int frame_bits;
+
+    frame_bits = ctx->frame_bits_const;
+
+    for (blk = 0; blk < A52_NUM_BLOCKS; blk++) {
+        block = &frame->blocks[blk];
+        for (ch = 0; ch < ctx->n_channels; ch++) {
+            if (block->exp_strategy[ch] != EXP_REUSE) {
+                frame_bits += 6; // chbwcod
+                frame_bits += 2; // gainrng
+            }
+        }
+        if (block->write_snr) {
+            frame_bits += 6; // csnroffset
+            frame_bits += ctx->n_all_channels * 4; // fsnroffset
+            frame_bits += ctx->n_all_channels * 3; // fgaincod
+        }
+    }
+
     frame->frame_bits = frame_bits;
 }
 
+/**
+ * Estimates mantissa bits from a histogram of bap table addresses.
+ * @p snroffst must be a multiple of 8.
+ */
+static int
+estimate_mant_bits(int *hist, int snroffst)
+{
+    FLOAT bits = FCONST(0.0);
+    int a, shift;
+
+    // snroffst/8 - 30 is the change in address from an SNR offset of 0
+    shift = (snroffst >> 3) - 30;
+    for (a = MAX(1 - shift, -128); a < 128; a++) {
+        if (hist[a+128])
+            bits += hist[a+128] * mant_est_tab[a52_bap_tab[MIN(a + shift, 63)]];
+    }
+    return (int)bits;
+}
+
+/**
+ * Predicts the snroffset at which the mantissas will fill the available bits.
+ * Rather than running the bit allocation, this gathers a histogram of bap
+ * table addresses from the psd and masking curve once, then searches the
+ * snroffset range using mantissa bits estimated from the histogram.  The
+ * error of this thread's previous prediction is added to the result, and
+ * the estimated number of mantissa bits per snroffset step is returned in
+ * @p slope.
+ */
+static int
+predict_snroffset(A52ThreadContext *tctx, int avail_bits, int *slope)
+{
+    A52Context *ctx = tctx->ctx;
+    A52Frame *frame = &tctx->frame;
+    A52Block *block;
+    int hist[256];
+    int blk, blk1, ch;
+    int lo, hi, mid, bits, bits_lo, bits_hi, snroffst;
+
+    memset(hist, 0, sizeof(hist));
+    for (ch = 0; ch < ctx->n_all_channels; ch++) {
+        for (blk = 0; blk < A52_NUM_BLOCKS; blk = blk1) {
+            // weight by the number of blocks sharing these exponents
+            for (blk1 = blk + 1; blk1 < A52_NUM_BLOCKS; blk1++) {
+                if (frame->blocks[blk1].exp_strategy[ch] != EXP_REUSE)
+                    break;
+            }
+            block = &frame->blocks[blk];
+            a52_bit_alloc_calc_bap_hist(block->mask[ch], block->psd[ch], 0,
+                                        frame->ncoefs[ch],
+                                        frame->bit_alloc.floor, blk1 - blk,
+                                        hist);
+        }
+    }
+
+    // search in steps of 8, where the histogram estimate is most accurate
+    lo = 0;
+    hi = 128;
+    bits_lo = estimate_mant_bits(hist, 0);
+    bits_hi = estimate_mant_bits(hist, 1024);
+    while (hi - lo > 1) {
+        mid = (lo + hi) >> 1;
+        bits = estimate_mant_bits(hist, mid << 3);
+        if (bits <= avail_bits) {
+            lo = mid;
+            bits_lo = bits;
+        } else {
+            hi = mid;
+            bits_hi = bits;
+        }
+    }
+    *slope = MAX((bits_hi - bits_lo) >> 3, 1);
+    snroffst = lo << 3;
+    if (bits_lo < avail_bits)
+        snroffst += MIN(((avail_bits - bits_lo) << 3) / MAX(bits_hi - bits_lo, 1), 8);
+
+    tctx->snr_prediction = snroffst;
+    return CLIP(snroffst + tctx->snr_prediction_error, 0, 1023);
+}
+
 /**
  * Calculates the snroffset values which, when used, keep the size of the
  * encoded data within a fixed frame size.
@@ -242,8 +348,8 @@ cbr_bit_allocation(A52ThreadContext *tctx, int prepare)
 {
     A52Context *ctx = tctx->ctx;
     A52Frame *frame = &tctx->frame;
-    int current_bits, avail_bits, leftover;
-    int snroffst=0;
+    int current_bits, avail_bits, leftover, leftover0, leftover1;
+    int snroffst, snr0, snr1, slope, margin, halve;
 
     current_bits = frame->frame_bits + frame->exp_bits;
     avail_bits = (16 * frame->frame_size) - current_bits;
@@ -252,67 +358,47 @@ cbr_bit_allocation(A52ThreadContext *tctx, int prepare)
         bit_alloc_prepare(tctx);
 
     // starting point
-    if (ctx->params.encoding_mode == AFTEN_ENC_MODE_VBR)
-        snroffst = ctx->params.quality;
-    else if (ctx->params.encoding_mode == AFTEN_ENC_MODE_CBR)
-        snroffst = tctx->last_quality;
+    snroffst = predict_snroffset(tctx, avail_bits, &slope);
     leftover = avail_bits - bit_alloc(tctx, snroffst);
 
-    if (ctx->params.bitalloc_fast) {
-        // fast bit allocation
-        int leftover0, leftover1, snr0, snr1;
-        snr0 = snr1 = snroffst;
-        leftover0 = leftover1 = leftover;
-        if (leftover != 0) {
-            if (leftover > 0) {
-                while (leftover1 > 0 && snr1+16 <= 1023) {
-                    snr0 = snr1;
-                    leftover0 = leftover1;
-                    snr1 += 16;
-                    leftover1 = avail_bits - bit_alloc(tctx, snr1);
-                }
-            } else {
-                while (leftover0 < 0 && snr0-16 >= 0) {
-                    snr1 = snr0;
-                    leftover1 = leftover0;
-                    snr0 -= 16;
-                    leftover0 = avail_bits - bit_alloc(tctx, snr0);
-                }
-            }
-        }
-        if (snr0 != snr1) {
-            snroffst = snr0;
-            leftover = avail_bits - bit_alloc(tctx, snroffst);
-        }
-    } else {
-        // take up to 3 jumps based on estimated distance from optimal
-        if (leftover < -400) {
-            snroffst += (leftover / (16 * ctx->n_channels));
-            leftover = avail_bits - bit_alloc(tctx, snroffst);
-        }
-        if (leftover > 400) {
-            snroffst += (leftover / (24 * ctx->n_channels));
-            leftover = avail_bits - bit_alloc(tctx, snroffst);
-        }
-        if (leftover < -200) {
-            snroffst += (leftover / (40 * ctx->n_channels));
-            leftover = avail_bits - bit_alloc(tctx, snroffst);
-        }
-        // adjust snroffst until leftover <= -100
-        while (leftover > -100) {
-            snroffst += (10 / ctx->n_channels);
-            if (snroffst > 1023) {
-                snroffst = 1023;
-                leftover = avail_bits - bit_alloc(tctx, snroffst);
-                break;
-            }
-            leftover = avail_bits - bit_alloc(tctx, snroffst);
+    // narrow down a bracket around the highest snroffst which fits.
+    // snr0 fits and snr1 does not, -1 and 1024 mean not yet found.
+    // fast bit allocation stops once the bracket is within 16.
+    margin = ctx->params.bitalloc_fast ? 16 : 1;
+    leftover0 = leftover1 = 0;
+    snr0 = -1;
+    snr1 = 1024;
+    halve = 0;
+    while (1) {
+        if (leftover >= 0) {
+            snr0 = snroffst;
+            leftover0 = leftover;
+        } else {
+            snr1 = snroffst;
+            leftover1 = leftover;
         }
-        // adjust snroffst until leftover is positive
-        while (leftover < 0 && snroffst > 0) {
-            snroffst--;
-            leftover = avail_bits - bit_alloc(tctx, snroffst);
+        if (snr1 - snr0 <= 1 || (snr0 >= 0 && snr1 - snr0 <= margin))
+            break;
+        if (snr0 < 0 || snr1 > 1023) {
+            // extrapolate using the predicted slope
+            snroffst += leftover / slope + (leftover < 0 ? -1 : 1);
+        } else if (halve) {
+            snroffst = (snr0 + snr1) >> 1;
+        } else {
+            // interpolate between the bracket ends
+            snroffst = snr0 + (leftover0 * (snr1 - snr0)) /
+                              (leftover0 - leftover1);
         }
+        // alternate with bisection to guarantee progress
+        halve = !halve;
+        snroffst = CLIP(snroffst, snr0 + 1, snr1 - 1);
+        leftover = avail_bits - bit_alloc(tctx, snroffst);
+    }
+    // the bit allocation pointers must match the final snroffst
+    if (snr0 >= 0 && snroffst != snr0) {
+        snroffst = snr0;
+        leftover = leftover0;
+        bit_alloc(tctx, snroffst);
     }
 
     frame->mant_bits = avail_bits - leftover;
@@ -325,7 +411,7 @@ cbr_bit_allocation(A52ThreadContext *tctx, int prepare)
     frame->csnroffst = snroffst >> 4;
     frame->fsnroffst = snroffst & 0xF;
     frame->quality = snroffst;
-    tctx->last_quality = snroffst;
+    tctx->snr_prediction_error = snroffst - tctx->snr_prediction;
 
     return 0;
 }
@@ -369,6 +455,76 @@ vbr_bit_allocation(A52ThreadContext *tctx)
     return cbr_bit_allocation(tctx, 0);
 }
 
+/**
+ * Chooses the frame size for average bitrate mode.
+ * The demand estimates of all queued frames give a linear model of bits
+ * versus snroffset for the lookahead window.  The quality which spends the
+ * window's share of the average bitrate, while steering the reservoir toward
+ * half full, sets the size requested for the current frame.  That size is
+ * then bounded so the reservoir neither underflows nor overflows.
+ */
+static int
+abr_bit_allocation(A52ThreadContext *tctx)
+{
+    A52Context *ctx = tctx->ctx;
+    A52RateControl *rc = &ctx->rc;
+    A52Frame *frame = &tctx->frame;
+    A52Frame *f;
+    FLOAT slope, sum_bits, sum_slope, budget;
+    int64_t max_bits, min_bits;
+    int i, q, bits, cod;
+
+    sum_bits = sum_slope = FCONST(0.0);
+    for (i = 0; i < rc->queued; i++) {
+        f = &ctx->tctx[(rc->head + i) % (rc->lookahead + 1)].frame;
+        slope = (FLOAT)(f->est_bits[1] - f->est_bits[0]) / ABR_EST_STEP;
+        sum_bits += f->est_bits[0] - slope * f->est_quality;
+        sum_slope += slope;
+    }
+    budget = (FLOAT)(rc->queued * rc->target + rc->fill - rc->size / 2) /
+             ctx->sample_rate;
+    q = 1023;
+    if (sum_slope > FCONST(0.0))
+        q = CLIP((int)((budget - sum_bits) / sum_slope), 0, 1023);
+
+    // smallest frame size which holds the estimated bits at that quality
+    slope = (FLOAT)(frame->est_bits[1] - frame->est_bits[0]) / ABR_EST_STEP;
+    bits = frame->est_bits[0] + (int)(slope * (q - frame->est_quality));
+    for (cod = 0; cod < ctx->frmsizecod; cod++) {
+        if (a52_frame_size_tab[cod][ctx->fscod] >= bits)
+            break;
+    }
+
+    // keep the reservoir within bounds
+    min_bits = (rc->target + rc->fill - rc->size) / ctx->sample_rate;
+    max_bits = (rc->target + rc->fill) / ctx->sample_rate;
+    while (cod < ctx->frmsizecod && a52_frame_size_tab[cod][ctx->fscod] < min_bits)
+        cod++;
+    while (cod > 0 && a52_frame_size_tab[cod][ctx->fscod] > max_bits)
+        cod--;
+
+    // the frame must still hold its data at the lowest quality.  the linear
+    // estimate can fall below that, e.g. on the zero-padded flush frame, so
+    // this is checked for every frame.  any overshoot is taken from the
+    // reservoir below.
+    bits = frame->frame_bits + frame->exp_bits + bit_alloc(tctx, 0);
+    while (cod < ctx->frmsizecod && a52_frame_size_tab[cod][ctx->fscod] < bits)
+        cod++;
+
+    frame->bit_rate = a52_bitrate_tab[cod/2] >> ctx->halfratecod;
+    frame->frmsizecod = cod;
+    frame->frame_size = a52_frame_size_tab[cod][ctx->fscod] / 16;
+    frame->frame_size_min = frame->frame_size;
+
+    if (cbr_bit_allocation(tctx, 0))
+        return -1;
+
+    rc->fill += rc->target - (int64_t)frame->frame_size * 16 * ctx->sample_rate;
+    rc->quality = frame->quality;
+
+    return 0;
+}
+
 /**
  * Loads the bit allocation parameters and counts fixed frame bits.
  */
@@ -407,48 +563,64 @@ start_bit_allocation(A52ThreadContext *tctx)
     count_frame_bits(tctx);
 }
 
-/** estimated number of bits used for a mantissa, indexed by bap value. */
-static FLOAT mant_est_tab[16] = {
-    FCONST( 0.000), FCONST( 1.667),
-    FCONST( 2.333), FCONST( 3.000),
-    FCONST( 3.500), FCONST( 4.000),
-    FCONST( 5.000), FCONST( 6.000),
-    FCONST( 7.000), FCONST( 8.000),
-    FCONST( 9.000), FCONST(10.000),
-    FCONST(11.000), FCONST(12.000),
-    FCONST(14.000), FCONST(16.000)
-};
+/**
+ * Estimates the bit demand of a frame for average bitrate mode.
+ * The total frame size is measured at 2 snroffset values around the current
+ * rate control quality.  This is done when the frame enters the lookahead
+ * queue, and the psd and masking curve are kept for the final allocation.
+ */
+void
+abr_estimate_bits(A52ThreadContext *tctx)
+{
+    A52Context *ctx = tctx->ctx;
+    A52Frame *frame = &tctx->frame;
+    int current_bits, q;
+
+    start_bit_allocation(tctx);
+    bit_alloc_prepare(tctx);
+
+    current_bits = frame->frame_bits + frame->exp_bits;
+    q = CLIP(ctx->rc.quality, 0, 1023 - ABR_EST_STEP);
+    frame->est_quality = q;
+    frame->est_bits[0] = current_bits + bit_alloc(tctx, q);
+    frame->est_bits[1] = current_bits + bit_alloc(tctx, q + ABR_EST_STEP);
+}
 
 /**
  * Variable bandwidth bit allocation
  * This estimates the bandwidth code which will give quality around 240.
+ * It runs on the exponents encoded at full bandwidth.  Only blocks which
+ * send new exponents get a bap calculation, and their estimated bits are
+ * weighted by the number of blocks which reuse them.  The exponents are not
+ * encoded again for the chosen bandwidth, they only have to be regrouped.
  */
 void
 vbw_bit_allocation(A52ThreadContext *tctx)
 {
     A52Context *ctx = tctx->ctx;
     A52Frame *frame = &tctx->frame;
-    FLOAT mant_bits;
-    int blk, ch, bw, nc;
+    A52Block *block;
+    FLOAT mant_bits, bin_bits[256];
+    int blk, blk1, ch, bw, nc;
     int avail_bits, bits;
-    int wmin, wmax, ncmin, ncmax;
+    int wmin, wmax, ncmin, ncmax, end;
 
     start_bit_allocation(tctx);
     avail_bits = (16 * frame->frame_size) - frame->frame_bits;
 
     bit_alloc_prepare(tctx);
-    bit_alloc(tctx, 240);
 
     // deduct any LFE exponent and mantissa bits
     if (ctx->lfe) {
         FLOAT lfe_bits = FCONST(0.0);
+        uint8_t *bap = frame->blocks[0].bap[ctx->lfe_channel];
         ch = ctx->lfe_channel;
         lfe_bits += expstr_set_bits[frame->expstr_set[ch]][7];
-        for (blk = 0; blk < A52_NUM_BLOCKS; blk++) {
-            uint8_t *bap = frame->blocks[blk].bap[ch];
-            for (nc = 0; nc < 7; nc++)
-                lfe_bits += mant_est_tab[bap[nc]];
-        }
+        a52_bit_alloc_calc_bap(frame->blocks[0].mask[ch],
+                               frame->blocks[0].psd[ch], 0, 7, 0,
+                               frame->bit_alloc.floor, bap);
+        for (nc = 0; nc < 7; nc++)
+            lfe_bits += A52_NUM_BLOCKS * mant_est_tab[bap[nc]];
         avail_bits -= (int)lfe_bits;
     }
 
@@ -458,25 +630,35 @@ vbw_bit_allocation(A52ThreadContext *tctx)
     ncmin = wmin * 3 + 73;
     ncmax = wmax * 3 + 73;
 
-    // sum up mantissa bits up to bin 72
-    mant_bits = FCONST(0.0);
+    // estimated mantissa bits per bin at q=240 for all channels and blocks
+    for (nc = 0; nc <= ncmax; nc++)
+        bin_bits[nc] = FCONST(0.0);
+    end = MIN(ncmax + 1, frame->ncoefs[0]);
     for (ch = 0; ch < ctx->n_channels; ch++) {
-        for (blk = 0; blk < A52_NUM_BLOCKS; blk++) {
-            uint8_t *bap = frame->blocks[blk].bap[ch];
-            for (nc = 0; nc < ncmin; nc++)
-                mant_bits += mant_est_tab[bap[nc]];
+        for (blk = 0; blk < A52_NUM_BLOCKS; blk = blk1) {
+            block = &frame->blocks[blk];
+            blk1 = blk + 1;
+            while (blk1 < A52_NUM_BLOCKS &&
+                   frame->blocks[blk1].exp_strategy[ch] == EXP_REUSE)
+                blk1++;
+            a52_bit_alloc_calc_bap(block->mask[ch], block->psd[ch], 0, end,
+                                   0, frame->bit_alloc.floor, block->bap[ch]);
+            for (nc = 0; nc < end; nc++)
+                bin_bits[nc] += (blk1 - blk) * mant_est_tab[block->bap[ch][nc]];
         }
     }
 
+    // sum up mantissa bits up to the minimum bandwidth
+    mant_bits = FCONST(0.0);
+    for (nc = 0; nc < ncmin; nc++)
+        mant_bits += bin_bits[nc];
+
     // add bins while estimated bits fit in the frame
     for (nc = ncmin; nc <= ncmax; nc++) {
-        bw = (nc - 73) / 3;
         bits = 0;
-        for (ch = 0; ch < ctx->n_channels; ch++) {
+        for (ch = 0; ch < ctx->n_channels; ch++)
             bits += expstr_set_bits[frame->expstr_set[ch]][nc];
-            for (blk = 0; blk < A52_NUM_BLOCKS; blk++)
-                mant_bits += mant_est_tab[frame->blocks[blk].bap[ch][nc]];
-        }
+        mant_bits += bin_bits[nc];
         if ((bits + (int)mant_bits) > avail_bits)
             break;
     }
@@ -491,7 +673,7 @@ vbw_bit_allocation(A52ThreadContext *tctx)
 
 /**
  * Run the bit allocation encoding routine.
- * Runs the bit allocation in either CBR or VBR mode, depending on the mode
+ * Runs the bit allocation in CBR, VBR, or ABR mode, depending on the mode
  * selected by the user.
  */
 int
@@ -506,6 +688,10 @@ compute_bit_allocation(A52ThreadContext *tctx)
     } else if(ctx->params.encoding_mode == AFTEN_ENC_MODE_CBR) {
         if (cbr_bit_allocation(tctx, 1))
             return -1;
+    } else if(ctx->params.encoding_mode == AFTEN_ENC_MODE_ABR) {
+        // psd and mask were prepared by abr_estimate_bits
+        if (abr_bit_allocation(tctx))
+            return -1;
     } else {
         return -1;
     }
@@ -28,10 +28,15 @@
 #ifndef BITALLOC_H
 #define BITALLOC_H
 
+struct A52Context;
 struct A52ThreadContext;
 
+extern void count_const_frame_bits(struct A52Context *ctx);
+
 extern void vbw_bit_allocation(struct A52ThreadContext *tctx);
 
+extern void abr_estimate_bits(struct A52ThreadContext *tctx);
+
 extern int compute_bit_allocation(struct A52ThreadContext *tctx);
 
 #endif /* BITALLOC_H */
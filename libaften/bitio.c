@@ -37,7 +37,7 @@ bitwriter_init(BitWriter *bw, void *buf, int len)
     bw->buffer = buf;
     bw->buf_end = bw->buffer + len;
     bw->buf_ptr = bw->buffer;
-    bw->bit_left = 32;
+    bw->bit_left = 64;
     bw->bit_buf = 0;
     bw->eof = 0;
 }
@@ -45,66 +45,86 @@ bitwriter_init(BitWriter *bw, void *buf, int len)
 void
 bitwriter_flushbits(BitWriter *bw)
 {
-    bw->bit_buf <<= bw->bit_left;
-    while (bw->bit_left < 32) {
-        *bw->buf_ptr++ = bw->bit_buf >> 24;
-        bw->bit_buf <<= 8;
-        bw->bit_left += 8;
-    }
-    bw->bit_left = 32;
-    bw->bit_buf = 0;
-}
-
-void
-bitwriter_writebits(BitWriter *bw, int bits, uint32_t val)
-{
-    if (!bits || bits > 32)
-        return;
-    val = (val & ((1U << bits)-1));
-    if (bits <= bw->bit_left) {
-        bw->bit_buf = (bw->bit_buf << bits) | val;
-        bw->bit_left -= bits;
-    } else {
-        uint32_t bb = (bw->bit_buf << bw->bit_left) | (val >> (bits - bw->bit_left));
-        if (bw->buffer != NULL) {
-            if (bw->eof)
-                return;
-            if ((bw->buf_ptr+3) >= bw->buf_end) {
-                bw->eof = 1;
-                return;
-            }
-            *(uint32_t *)bw->buf_ptr = be2me_32(bb);
+    if (bw->bit_left < 64) {
+        bw->bit_buf <<= bw->bit_left;
+        while (bw->bit_left < 64 && bw->buf_ptr < bw->buf_end) {
+            *bw->buf_ptr++ = bw->bit_buf >> 56;
+            bw->bit_buf <<= 8;
+            bw->bit_left += 8;
         }
-        bw->bit_left += (32 - bits);
-        bw->buf_ptr += 4;
-        bw->bit_buf = val;
     }
+    bw->bit_left = 64;
+    bw->bit_buf = 0;
 }
 
 void
 bitwriter_writebit(BitWriter *bw, uint8_t val)
 {
-    if (bw->bit_left) {
+    if (bw->bit_left > 1) {
         bw->bit_buf = (bw->bit_buf << 1) | (val & 1);
         bw->bit_left--;
     } else {
-        if (bw->buffer != NULL) {
-            if (bw->eof)
-                return;
-            if ((bw->buf_ptr+3) >= bw->buf_end) {
-                bw->eof = 1;
-                return;
-            }
-            *(uint32_t *)bw->buf_ptr = be2me_32(bw->bit_buf);
-        }
-        bw->bit_left = 31;
-        bw->buf_ptr += 4;
-        bw->bit_buf = (val & 1);
+        bitwriter_writebits(bw, 1, val);
     }
 }
 
 uint32_t
 bitwriter_bitcount(BitWriter *bw)
 {
-    return (((bw->buf_ptr - bw->buffer) << 3) + 32 - bw->bit_left);
+    return (((bw->buf_ptr - bw->buffer) << 3) + 64 - bw->bit_left);
+}
+
+/**
+ * Fill in a field of 'bits' zero bits which was written earlier at bit
+ * position 'pos'.  The field may be partly or completely in the 64-bit
+ * buffer, or already stored in the output buffer.
+ */
+void
+bitwriter_patchbits(BitWriter *bw, uint32_t pos, int bits, uint32_t val)
+{
+    uint32_t stored, end;
+    int n, sh;
+
+    if (bw->buffer == NULL || bw->eof)
+        return;
+    stored = (bw->buf_ptr - bw->buffer) << 3;
+    end = pos + bits;
+
+    // low bits which are still in the bit buffer
+    if (end > stored) {
+        n = MIN(bits, (int)(end - stored));
+        bw->bit_buf |= (uint64_t)(val & ((1U << n) - 1)) <<
+                       (stored + 64 - bw->bit_left - end);
+        val >>= n;
+        bits -= n;
+        end -= n;
+    }
+
+    // remaining high bits, one output byte at a time
+    while (bits > 0) {
+        sh = 7 - ((end - 1) & 7);
+        n = MIN(bits, 8 - sh);
+        bw->buffer[(end - 1) >> 3] |= (val & ((1U << n) - 1)) << sh;
+        val >>= n;
+        bits -= n;
+        end -= n;
+    }
+}
+
+/**
+ * Write 'bits' bits which were rendered earlier into a byte array, starting
+ * with the most significant bit of src[0].
+ */
+void
+bitwriter_copybits(BitWriter *bw, const uint8_t *src, int bits)
+{
+    for (; bits >= 32; bits -= 32, src += 4) {
+        bitwriter_writebits(bw, 32, ((uint32_t)src[0] << 24) |
+                                    ((uint32_t)src[1] << 16) |
+                                    ((uint32_t)src[2] <<  8) | src[3]);
+    }
+    for (; bits >= 8; bits -= 8)
+        bitwriter_writebits(bw, 8, *src++);
+    if (bits > 0)
+        bitwriter_writebits(bw, bits, *src >> (8 - bits));
 }
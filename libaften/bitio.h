@@ -31,7 +31,7 @@
 #include "common.h"
 
 typedef struct BitWriter {
-    uint32_t bit_buf;
+    uint64_t bit_buf;
     int bit_left;
     uint8_t *buffer, *buf_ptr, *buf_end;
     int eof;
@@ -41,10 +41,80 @@ extern void bitwriter_init(BitWriter *bw, void *buf, int len);
 
 extern void bitwriter_flushbits(BitWriter *bw);
 
-extern void bitwriter_writebits(BitWriter *bw, int bits, uint32_t val);
-
 extern void bitwriter_writebit(BitWriter *bw, uint8_t val);
 
 extern uint32_t bitwriter_bitcount(BitWriter *bw);
 
+extern void bitwriter_patchbits(BitWriter *bw, uint32_t pos, int bits,
+                                uint32_t val);
+
+extern void bitwriter_copybits(BitWriter *bw, const uint8_t *src, int bits);
+
+/**
+ * Write up to 32 bits.  The 64-bit buffer is stored once it is full, and
+ * stops being stored when the output buffer would overflow.
+ */
+static inline void
+bitwriter_writebits(BitWriter *bw, int bits, uint32_t val)
+{
+    uint64_t bb;
+
+    if (!bits || bits > 32)
+        return;
+    val = (uint32_t)(val & ((UINT64_C(1) << bits) - 1));
+    if (bits < bw->bit_left) {
+        bw->bit_buf = (bw->bit_buf << bits) | val;
+        bw->bit_left -= bits;
+    } else {
+        bb = (bw->bit_buf << bw->bit_left) |
+             (val >> (bits - bw->bit_left));
+        if (bw->buffer != NULL) {
+            if (bw->eof)
+                return;
+            if ((bw->buf_ptr+7) >= bw->buf_end) {
+                bw->eof = 1;
+                return;
+            }
+            *(uint64_t *)bw->buf_ptr = be2me_64(bb);
+        }
+        bw->bit_left += (64 - bits);
+        bw->buf_ptr += 8;
+        bw->bit_buf = val;
+    }
+}
+
+/**
+ * Check that 'bits' more bits can be written with
+ * bitwriter_writebits_unchecked().
+ */
+static inline int
+bitwriter_has_room(BitWriter *bw, int bits)
+{
+    return bw->buffer != NULL && !bw->eof &&
+           (bw->buf_end - bw->buf_ptr) >= (bits >> 3) + 16;
+}
+
+/**
+ * Write up to 32 bits without checking the end of the output buffer.  The
+ * value must not have any bits set above 'bits', and the caller must have
+ * checked the available space with bitwriter_has_room().
+ */
+static inline void
+bitwriter_writebits_unchecked(BitWriter *bw, int bits, uint32_t val)
+{
+    uint64_t bb;
+
+    if (bits < bw->bit_left) {
+        bw->bit_buf = (bw->bit_buf << bits) | val;
+        bw->bit_left -= bits;
+    } else {
+        bb = (bw->bit_buf << bw->bit_left) |
+             (val >> (bits - bw->bit_left));
+        *(uint64_t *)bw->buf_ptr = be2me_64(bb);
+        bw->bit_left += (64 - bits);
+        bw->buf_ptr += 8;
+        bw->bit_buf = val;
+    }
+}
+
 #endif /* BITIO_H */
@@ -28,9 +28,10 @@
 
 #include "a52enc.h"
 #include "convert.h"
+#include "cpu_caps.h"
 
 static void
-fmt_convert_from_u8(FLOAT dest[A52_MAX_CHANNELS][A52_SAMPLES_PER_FRAME],
+fmt_convert_from_u8(FLOAT **dest,
                     const void *vsrc, int nch, int n)
 {
     int i, j, ch;
@@ -46,7 +47,7 @@ fmt_convert_from_u8(FLOAT dest[A52_MAX_CHANNELS][A52_SAMPLES_PER_FRAME],
 }
 
 static void
-fmt_convert_from_s8(FLOAT dest[A52_MAX_CHANNELS][A52_SAMPLES_PER_FRAME],
+fmt_convert_from_s8(FLOAT **dest,
                     const void *vsrc, int nch, int n)
 {
     int i, j, ch;
@@ -62,7 +63,7 @@ fmt_convert_from_s8(FLOAT dest[A52_MAX_CHANNELS][A52_SAMPLES_PER_FRAME],
 }
 
 static void
-fmt_convert_from_s16(FLOAT dest[A52_MAX_CHANNELS][A52_SAMPLES_PER_FRAME],
+fmt_convert_from_s16(FLOAT **dest,
                      const void *vsrc, int nch, int n)
 {
     int i, j, ch;
@@ -78,7 +79,7 @@ fmt_convert_from_s16(FLOAT dest[A52_MAX_CHANNELS][A52_SAMPLES_PER_FRAME],
 }
 
 static void
-fmt_convert_from_s20(FLOAT dest[A52_MAX_CHANNELS][A52_SAMPLES_PER_FRAME],
+fmt_convert_from_s20(FLOAT **dest,
                      const void *vsrc, int nch, int n)
 {
     int i, j, ch;
@@ -94,7 +95,7 @@ fmt_convert_from_s20(FLOAT dest[A52_MAX_CHANNELS][A52_SAMPLES_PER_FRAME],
 }
 
 static void
-fmt_convert_from_s24(FLOAT dest[A52_MAX_CHANNELS][A52_SAMPLES_PER_FRAME],
+fmt_convert_from_s24(FLOAT **dest,
                      const void *vsrc, int nch, int n)
 {
     int i, j, ch;
@@ -110,7 +111,7 @@ fmt_convert_from_s24(FLOAT dest[A52_MAX_CHANNELS][A52_SAMPLES_PER_FRAME],
 }
 
 static void
-fmt_convert_from_s32(FLOAT dest[A52_MAX_CHANNELS][A52_SAMPLES_PER_FRAME],
+fmt_convert_from_s32(FLOAT **dest,
                      const void *vsrc, int nch, int n)
 {
     int i, j, ch;
@@ -126,7 +127,7 @@ fmt_convert_from_s32(FLOAT dest[A52_MAX_CHANNELS][A52_SAMPLES_PER_FRAME],
 }
 
 static void
-fmt_convert_from_float(FLOAT dest[A52_MAX_CHANNELS][A52_SAMPLES_PER_FRAME],
+fmt_convert_from_float(FLOAT **dest,
                        const void *vsrc, int nch, int n)
 {
     int i, j, ch;
@@ -142,7 +143,7 @@ fmt_convert_from_float(FLOAT dest[A52_MAX_CHANNELS][A52_SAMPLES_PER_FRAME],
 }
 
 static void
-fmt_convert_from_double(FLOAT dest[A52_MAX_CHANNELS][A52_SAMPLES_PER_FRAME],
+fmt_convert_from_double(FLOAT **dest,
                         const void *vsrc, int nch, int n)
 {
     int i, j, ch;
@@ -157,26 +158,57 @@ fmt_convert_from_double(FLOAT dest[A52_MAX_CHANNELS][A52_SAMPLES_PER_FRAME],
     }
 }
 
-void
-set_converter(A52Context *ctx, A52SampleFormat sample_format)
+/** one channel of planar input in the native FLOAT type is just copied */
+static void
+fmt_copy_native(FLOAT **dest, const void *vsrc, UNUSED(int nch), int n)
+{
+    memcpy(dest[0], vsrc, n * sizeof(FLOAT));
+}
+
+typedef void (*ConvertFunc)(FLOAT **dest, const void *vsrc, int nch, int n);
+
+static ConvertFunc
+get_converter(A52SampleFormat sample_format, int nch)
 {
+#if defined(HAVE_SSE2) && !defined(CONFIG_DOUBLE)
+    if (cpu_caps_have_sse2() && (nch == 1 || nch == 2 || nch == 6)) {
+        switch (sample_format) {
+        case A52_SAMPLE_FMT_S16: return fmt_convert_from_s16_sse2;
+        case A52_SAMPLE_FMT_S20: return fmt_convert_from_s20_sse2;
+        case A52_SAMPLE_FMT_S24: return fmt_convert_from_s24_sse2;
+        case A52_SAMPLE_FMT_S32: return fmt_convert_from_s32_sse2;
+        case A52_SAMPLE_FMT_FLT: return fmt_convert_from_float_sse2;
+        default: break;
+        }
+    }
+#else
+    (void)nch;
+#endif
     switch (sample_format) {
-    case A52_SAMPLE_FMT_U8:  ctx->fmt_convert_from_src = fmt_convert_from_u8;
-        break;
-    case A52_SAMPLE_FMT_S8:  ctx->fmt_convert_from_src = fmt_convert_from_s8;
-        break;
-    case A52_SAMPLE_FMT_S16: ctx->fmt_convert_from_src = fmt_convert_from_s16;
-        break;
-    case A52_SAMPLE_FMT_S20: ctx->fmt_convert_from_src = fmt_convert_from_s20;
-        break;
-    case A52_SAMPLE_FMT_S24: ctx->fmt_convert_from_src = fmt_convert_from_s24;
-        break;
-    case A52_SAMPLE_FMT_S32: ctx->fmt_convert_from_src = fmt_convert_from_s32;
-        break;
-    case A52_SAMPLE_FMT_FLT: ctx->fmt_convert_from_src = fmt_convert_from_float;
-        break;
-    case A52_SAMPLE_FMT_DBL: ctx->fmt_convert_from_src = fmt_convert_from_double;
-        break;
-    default: break;
+    case A52_SAMPLE_FMT_U8:  return fmt_convert_from_u8;
+    case A52_SAMPLE_FMT_S8:  return fmt_convert_from_s8;
+    case A52_SAMPLE_FMT_S16: return fmt_convert_from_s16;
+    case A52_SAMPLE_FMT_S20: return fmt_convert_from_s20;
+    case A52_SAMPLE_FMT_S24: return fmt_convert_from_s24;
+    case A52_SAMPLE_FMT_S32: return fmt_convert_from_s32;
+    case A52_SAMPLE_FMT_FLT: return fmt_convert_from_float;
+    case A52_SAMPLE_FMT_DBL: return fmt_convert_from_double;
+    default: return NULL;
     }
 }
+
+void
+set_converter(A52Context *ctx, A52SampleFormat sample_format)
+{
+    ctx->fmt_convert_from_src = get_converter(sample_format, ctx->n_all_channels);
+
+    // planar input is converted one channel at a time, as mono input
+#ifdef CONFIG_DOUBLE
+    if (sample_format == A52_SAMPLE_FMT_DBL)
+#else
+    if (sample_format == A52_SAMPLE_FMT_FLT)
+#endif
+        ctx->fmt_convert_channel = fmt_copy_native;
+    else
+        ctx->fmt_convert_channel = get_converter(sample_format, 1);
+}
@@ -28,6 +28,10 @@
 
 #include "common.h"
 
+#if defined(HAVE_MMX) || defined(HAVE_SSE)
+#include "x86/convert.h"
+#endif
+
 struct A52Context;
 
 void set_converter(A52Context *ctx, A52SampleFormat sample_format);
@@ -26,64 +26,19 @@
  */
 
 #include "crc.h"
+#include "aften-types.h"
+#include "cpu_caps.h"
 
 #define CRC16_POLY  0x18005
 
-#ifdef WORDS_BIGENDIAN
-#define LOW_BYTE 1
-#define HIGH_BYTE 0
-#else
-#define LOW_BYTE 0
-#define HIGH_BYTE 1
-#endif
-
-union crc_t
-{
-    uint16_t word;
-    uint8_t bytes[2];
-};
-
-
-static void
-crc_init_table(uint16_t *table, int bits, int poly)
-{
-    int i, j, crc;
-
-    poly = (poly + (1<<bits));
-    for (i = 0; i < 256; i++) {
-        crc = i;
-        for (j = 0; j < bits; j++) {
-            if (crc & (1<<(bits-1)))
-                crc = (crc << 1) ^ poly;
-            else
-                crc <<= 1;
-        }
-        table[i] = bswap_16(crc & ((1<<bits)-1));
-    }
-}
-
-static uint16_t crc16tab[256];
-
-void
-crc_init()
-{
-    crc_init_table(crc16tab, 16, CRC16_POLY);
-}
-
-uint16_t
-calc_crc16(const uint8_t *data, uint32_t len)
-{
-    union crc_t crc = {0};
-
-    assert(data != NULL);
+/**
+ * Slice-by-8 tables.  crc16tab[0] is the usual byte-wise table, and
+ * crc16tab[k][i] is the crc of byte i followed by k zero bytes.
+ */
+static uint16_t crc16tab[8][256];
 
-    while (len--) {
-        uint16_t v1 = crc.bytes[HIGH_BYTE];
-        uint16_t v2 = crc.bytes[LOW_BYTE] ^ *data++;
-        crc.word = v1 ^ crc16tab[v2];
-    }
-    return bswap_16(crc.word);
-}
+/** x^(-8*n) mod P for every byte count n, used by crc16_zero() */
+static uint16_t crc16_inv_tab[A52_MAX_CODED_FRAME_SIZE+1];
 
 static uint16_t
 mul_poly(uint32_t a, uint32_t b)
@@ -100,6 +55,43 @@ mul_poly(uint32_t a, uint32_t b)
     return c;
 }
 
+static void
+crc_init_table(void)
+{
+    int i, j, k, crc;
+
+    for (i = 0; i < 256; i++) {
+        crc = i << 8;
+        for (j = 0; j < 8; j++) {
+            if (crc & 0x8000)
+                crc = (crc << 1) ^ CRC16_POLY;
+            else
+                crc <<= 1;
+        }
+        crc16tab[0][i] = crc;
+    }
+    for (k = 1; k < 8; k++) {
+        for (i = 0; i < 256; i++) {
+            crc = crc16tab[k-1][i];
+            crc16tab[k][i] = (crc << 8) ^ crc16tab[0][crc >> 8];
+        }
+    }
+}
+
+static void
+crc_init_inv_table(void)
+{
+    // (CRC16_POLY >> 1) is x^-1 mod P
+    uint32_t inv8 = 1;
+    int n;
+
+    for (n = 0; n < 8; n++)
+        inv8 = mul_poly(inv8, CRC16_POLY >> 1);
+    crc16_inv_tab[0] = 1;
+    for (n = 1; n <= A52_MAX_CODED_FRAME_SIZE; n++)
+        crc16_inv_tab[n] = mul_poly(crc16_inv_tab[n-1], inv8);
+}
+
 static uint32_t
 pow_poly(uint32_t n)
 {
@@ -114,6 +106,100 @@ pow_poly(uint32_t n)
     return r;
 }
 
+static uint16_t
+crc16_update_bytewise(uint16_t crc, const uint8_t *data, uint32_t len)
+{
+    uint32_t c = crc;
+
+    while (len--)
+        c = ((c << 8) & 0xFFFF) ^ crc16tab[0][*data++ ^ (c >> 8)];
+    return c;
+}
+
+static uint16_t
+crc16_update(uint16_t crc, const uint8_t *data, uint32_t len)
+{
+    uint32_t c = crc;
+
+    while (len >= 8) {
+        c = crc16tab[7][data[0] ^ (c >> 8)] ^
+            crc16tab[6][data[1] ^ (c & 0xFF)] ^
+            crc16tab[5][data[2]] ^ crc16tab[4][data[3]] ^
+            crc16tab[3][data[4]] ^ crc16tab[2][data[5]] ^
+            crc16tab[1][data[6]] ^ crc16tab[0][data[7]];
+        data += 8;
+        len -= 8;
+    }
+    while (len--)
+        c = ((c << 8) & 0xFFFF) ^ crc16tab[0][*data++ ^ (c >> 8)];
+    return c;
+}
+
+static enum CrcImpl crc_impl = CRC_IMPL_SLICE8;
+
+void
+crc_init()
+{
+    static int tables_done = 0;
+
+    if (!tables_done) {
+        crc_init_table();
+        crc_init_inv_table();
+        tables_done = 1;
+    }
+    crc_impl = CRC_IMPL_SLICE8;
+#ifdef HAVE_PCLMUL
+    if (cpu_caps_have_pclmul()) {
+        crc_init_pclmul(CRC16_POLY);
+        crc_impl = CRC_IMPL_PCLMUL;
+    }
+#endif
+}
+
+int
+crc_select(enum CrcImpl impl)
+{
+    switch (impl) {
+        case CRC_IMPL_BYTEWISE:
+        case CRC_IMPL_SLICE8:
+            break;
+        case CRC_IMPL_PCLMUL:
+#ifdef HAVE_PCLMUL
+            if (cpu_caps_have_pclmul()) {
+                crc_init_pclmul(CRC16_POLY);
+                break;
+            }
+#endif
+            return -1;
+        default:
+            return -1;
+    }
+    crc_impl = impl;
+    return 0;
+}
+
+uint16_t
+calc_crc16(const uint8_t *data, uint32_t len)
+{
+    assert(data != NULL);
+
+#ifdef HAVE_PCLMUL
+    if (crc_impl == CRC_IMPL_PCLMUL && len >= 64) {
+        uint8_t folded[16];
+        uint32_t n = len & ~15;
+        uint16_t crc;
+
+        // fold all whole 16-byte blocks into one block with the same crc
+        crc16_fold_pclmul(data, n, folded);
+        crc = crc16_update(0, folded, 16);
+        return crc16_update(crc, data + n, len - n);
+    }
+#endif
+    if (crc_impl == CRC_IMPL_BYTEWISE)
+        return crc16_update_bytewise(0, data, len);
+    return crc16_update(0, data, len);
+}
+
 /**
  * calculates crc value which will result in zero crc
  * where the crc is the first 2 bytes of the data
@@ -123,8 +209,7 @@ pow_poly(uint32_t n)
 uint16_t
 crc16_zero(uint16_t crc, int size)
 {
-    int crc_inv;
-    crc_inv = pow_poly(size*8);
-    crc = mul_poly(crc_inv, crc);
-    return crc;
+    if (crc_impl == CRC_IMPL_BYTEWISE)
+        return mul_poly(pow_poly(size*8), crc);
+    return mul_poly(crc16_inv_tab[size], crc);
 }
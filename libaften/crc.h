@@ -30,8 +30,28 @@
 
 #include "common.h"
 
+#if defined(HAVE_MMX) || defined(HAVE_SSE)
+#include "x86/crc.h"
+#endif
+
+/** CRC-16 implementations, which can be chosen with crc_select() */
+enum CrcImpl {
+    CRC_IMPL_BYTEWISE = 0,
+    CRC_IMPL_SLICE8,
+    CRC_IMPL_PCLMUL
+};
+
 extern void crc_init(void);
 
+/**
+ * Chooses the implementation used by calc_crc16() and crc16_zero(), so
+ * they can be compared.  crc_init() selects the fastest one available.
+ * The bytewise implementation also computes crc16_zero() the original way,
+ * without the table.
+ * @return 0 on success, or -1 if the implementation is not available
+ */
+extern int crc_select(enum CrcImpl impl);
+
 extern uint16_t calc_crc16(const uint8_t *buf, uint32_t len);
 
 extern uint16_t crc16_zero(uint16_t crc, int size);
@@ -136,8 +136,8 @@ compute_exponent_strategy(A52ThreadContext *tctx)
  * Encode exponent groups.  3 exponents are in per 7-bit group.  The number of
  * groups varies depending on exponent strategy and bandwidth
  */
-static void
-group_exponents(A52ThreadContext *tctx)
+void
+a52_group_exponents(A52ThreadContext *tctx)
 {
     A52Context *ctx = tctx->ctx;
     A52Frame *frame = &tctx->frame;
@@ -341,7 +341,7 @@ a52_process_exponents(A52ThreadContext *tctx)
 
     encode_exponents(tctx);
 
-    group_exponents(tctx);
+    a52_group_exponents(tctx);
 }
 
 
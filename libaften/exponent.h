@@ -64,4 +64,6 @@ extern void exponent_init(A52ExponentFunctions *expf);
 
 extern void a52_process_exponents(struct A52ThreadContext *tctx);
 
+extern void a52_group_exponents(struct A52ThreadContext *tctx);
+
 #endif /* EXPONENT_H */
@@ -308,19 +308,26 @@ onepole_init(FilterContext *f)
     return 0;
 }
 
+static FLOAT
+onepole_get_p1(FilterContext *f)
+{
+    OnePoleContext *o = f->private_context;
+
+    if (f->type == FILTER_TYPE_LOWPASS)
+        return FCONST(1.0) - o->p;
+    else if(f->type == FILTER_TYPE_HIGHPASS)
+        return o->p - FCONST(1.0);
+    return 0;
+}
+
 static void
 onepole_run_filter(FilterContext *f, FLOAT *out, FLOAT *in, int n)
 {
     int i;
     FLOAT v;
-    FLOAT p1 = 0;
+    FLOAT p1 = onepole_get_p1(f);
     OnePoleContext *o = f->private_context;
 
-    if (f->type == FILTER_TYPE_LOWPASS)
-        p1 = FCONST(1.0) - o->p;
-    else if(f->type == FILTER_TYPE_HIGHPASS)
-        p1 = o->p - FCONST(1.0);
-
     for (i = 0; i < n; i++) {
         v = (p1 * in[i]) + (o->p * o->last);
         o->last = out[i] = CLIP(v, -FCONST(1.0), FCONST(1.0));
@@ -337,7 +344,7 @@ static const Filter onepole_filter = {
 
 
 int
-filter_init(FilterContext *f, enum FilterID id)
+filter_init(FilterContext *f, enum FilterID id, MemArena *arena)
 {
     if(f == NULL) return -1;
 
@@ -355,7 +362,9 @@ filter_init(FilterContext *f, enum FilterID id)
         default:                        return -1;
     }
 
-    f->private_context = calloc(f->filter->private_size, 1);
+    f->private_context = mem_arena_alloc(arena, f->filter->private_size);
+    if (!f->private_context)
+        return -1;
 
     return f->filter->init(f);
 }
@@ -366,14 +375,382 @@ filter_run(FilterContext *f, FLOAT *out, FLOAT *in, int n)
     f->filter->filter(f, out, in, n);
 }
 
+/** offsets of each filter's values in the chain state */
+#define CHAIN_STATE_PRE   0
+#define CHAIN_STATE_MAIN  1
+#define CHAIN_STATE_TAP   5
+
+/** coefficients of one channel's filter chain */
+typedef struct ChainCoefs {
+    int pre;
+    int main_stages;
+    int tap_stages;
+    FLOAT p1, p;
+    FLOAT main[5];
+    FLOAT tap[5];
+} ChainCoefs;
+
+static int
+chain_get_coefs(const FilterChain *c, ChainCoefs *cc)
+{
+    enum FilterID id;
+
+    memset(cc, 0, sizeof(*cc));
+    if (c->pre) {
+        if (c->pre->filter->id != FILTER_ID_ONEPOLE)
+            return -1;
+        cc->pre = 1;
+        cc->p1 = onepole_get_p1(c->pre);
+        cc->p = ((OnePoleContext *)c->pre->private_context)->p;
+    }
+    if (c->main) {
+        id = c->main->filter->id;
+        if (id != FILTER_ID_BIQUAD_II && id != FILTER_ID_BUTTERWORTH_II)
+            return -1;
+        cc->main_stages = 1 + c->main->cascaded;
+        memcpy(cc->main, ((BiquadContext *)c->main->private_context)->coefs,
+               5 * sizeof(FLOAT));
+    }
+    if (c->tap) {
+        id = c->tap->filter->id;
+        if (id != FILTER_ID_BIQUAD_I && id != FILTER_ID_BUTTERWORTH_I)
+            return -1;
+        cc->tap_stages = 1 + c->tap->cascaded;
+        memcpy(cc->tap, ((BiquadContext *)c->tap->private_context)->coefs,
+               5 * sizeof(FLOAT));
+    }
+    return 0;
+}
+
+/**
+ * Run one sample through a filter chain.  The arithmetic is done in the
+ * same order as in filter_run_chain4_sse(), so both give the same output.
+ * With 'linear' set, the outputs are not clipped.
+ */
+static FLOAT
+chain_step(const ChainCoefs *cc, FLOAT *st, FLOAT x, FLOAT *t, int linear)
+{
+    const FLOAT *c;
+    FLOAT *s;
+    FLOAT v, y;
+    int j;
+
+    if (cc->pre) {
+        v = (cc->p1 * x) + (cc->p * st[CHAIN_STATE_PRE]);
+        x = linear ? v : CLIP(v, -FCONST(1.0), FCONST(1.0));
+        st[CHAIN_STATE_PRE] = x;
+    }
+    // biquad direct form II, state is s1, s2
+    c = cc->main;
+    for (j = 0; j < cc->main_stages; j++) {
+        s = &st[CHAIN_STATE_MAIN + 2*j];
+        v = c[0] * x + s[0];
+        s[0] = (c[1] * x - c[3] * v) + s[1];
+        s[1] = c[2] * x - c[4] * v;
+        x = linear ? v : CLIP(v, -FCONST(1.0), FCONST(1.0));
+    }
+    // biquad direct form I, state is s1 to s4
+    c = cc->tap;
+    y = x;
+    for (j = 0; j < cc->tap_stages; j++) {
+        s = &st[CHAIN_STATE_TAP + 4*j];
+        v = 0;
+        v += c[0] * y;
+        v += c[1] * s[0];
+        v += c[2] * s[1];
+        v -= c[3] * s[2];
+        v -= c[4] * s[3];
+        s[1] = s[0];
+        s[3] = s[2];
+        s[0] = y;
+        s[2] = v;
+        y = linear ? v : CLIP(v, -FCONST(1.0), FCONST(1.0));
+    }
+    *t = y;
+    return x;
+}
+
+/** runs a filter chain one channel and one sample at a time */
+static void
+filter_run_chain_c(const FilterChain *chain, int nch, FLOAT **state,
+                   FLOAT **in, FLOAT **out, FLOAT **tap, int n)
+{
+    ChainCoefs cc;
+    FLOAT x, t;
+    int ch, i;
+
+    for (ch = 0; ch < nch; ch++) {
+        if (chain_get_coefs(&chain[ch], &cc))
+            continue;
+        if (!cc.pre && !cc.main_stages && !cc.tap_stages) {
+            if (out && out[ch] != in[ch])
+                memcpy(out[ch], in[ch], n * sizeof(FLOAT));
+            if (tap)
+                memcpy(tap[ch], in[ch], n * sizeof(FLOAT));
+            continue;
+        }
+        for (i = 0; i < n; i++) {
+            x = chain_step(&cc, state[ch], in[ch][i], &t, 0);
+            if (out)
+                out[ch][i] = x;
+            if (tap)
+                tap[ch][i] = t;
+        }
+    }
+}
+
+#if defined(HAVE_SSE) && !defined(CONFIG_DOUBLE)
+/**
+ * Gather the coefficients and state of the chains of 4 channels.  A
+ * one-pole filter stores p1 and p as coefs[0] and coefs[1], and its last
+ * output as state[0][0].
+ * @return -1 if the lanes can not be run together, otherwise 0
+ */
+static int
+gather_lanes(FilterLanes fl[3], const ChainCoefs *cc, FLOAT **state)
+{
+    FLOAT *st;
+    int i, j, k;
+
+    memset(fl, 0, 3 * sizeof(*fl));
+    for (i = 0; i < 4; i++) {
+        st = state[i];
+        if (cc[i].pre) {
+            fl[0].stages = 1;
+            fl[0].enable[i] = FCONST(1.0);
+            fl[0].coefs[0][i] = cc[i].p1;
+            fl[0].coefs[1][i] = cc[i].p;
+            fl[0].state[0][0][i] = st[CHAIN_STATE_PRE];
+        }
+        if (cc[i].main_stages) {
+            if (fl[1].stages && fl[1].stages != cc[i].main_stages)
+                return -1;
+            fl[1].stages = cc[i].main_stages;
+            fl[1].enable[i] = FCONST(1.0);
+            for (k = 0; k < 5; k++)
+                fl[1].coefs[k][i] = cc[i].main[k];
+            for (j = 0; j < fl[1].stages; j++)
+                for (k = 1; k < 3; k++)
+                    fl[1].state[j][k][i] = st[CHAIN_STATE_MAIN + 2*j + k-1];
+        }
+        if (cc[i].tap_stages) {
+            if (fl[2].stages && fl[2].stages != cc[i].tap_stages)
+                return -1;
+            fl[2].stages = cc[i].tap_stages;
+            fl[2].enable[i] = FCONST(1.0);
+            for (k = 0; k < 5; k++)
+                fl[2].coefs[k][i] = cc[i].tap[k];
+            for (j = 0; j < fl[2].stages; j++)
+                for (k = 1; k < 5; k++)
+                    fl[2].state[j][k][i] = st[CHAIN_STATE_TAP + 4*j + k-1];
+        }
+    }
+    return 0;
+}
+
+static void
+scatter_lanes(const FilterLanes fl[3], const ChainCoefs *cc, FLOAT **state,
+              int used)
+{
+    FLOAT *st;
+    int i, j, k;
+
+    for (i = 0; i < used; i++) {
+        st = state[i];
+        if (cc[i].pre)
+            st[CHAIN_STATE_PRE] = fl[0].state[0][0][i];
+        for (j = 0; j < cc[i].main_stages; j++)
+            for (k = 1; k < 3; k++)
+                st[CHAIN_STATE_MAIN + 2*j + k-1] = fl[1].state[j][k][i];
+        for (j = 0; j < cc[i].tap_stages; j++)
+            for (k = 1; k < 5; k++)
+                st[CHAIN_STATE_TAP + 4*j + k-1] = fl[2].state[j][k][i];
+    }
+}
+
+/**
+ * Run a filter chain on up to 4 channels with SSE.  Spare lanes repeat the
+ * last channel.  They compute exactly the same samples as that channel, so
+ * their stores are harmless, and their state is not written back.
+ */
+static int
+filter_run_chain_sse(const FilterChain *chain, int nch, FLOAT **state,
+                     FLOAT **in, FLOAT **out, FLOAT **tap, int n)
+{
+    FilterLanes fl[3];
+    ChainCoefs cc[4];
+    FLOAT *l_state[4], *l_in[4], *l_out[4], *l_tap[4];
+    int i, ch;
+
+    for (i = 0; i < 4; i++) {
+        ch = MIN(i, nch - 1);
+        if (chain_get_coefs(&chain[ch], &cc[i]))
+            return -1;
+        l_state[i] = state[ch];
+        l_in[i] = in[ch];
+        l_out[i] = out ? out[ch] : NULL;
+        l_tap[i] = tap ? tap[ch] : NULL;
+    }
+    if (gather_lanes(fl, cc, l_state))
+        return -1;
+    // plain copies are left to the C version
+    if (!fl[0].stages && !fl[1].stages && !fl[2].stages)
+        return -1;
+
+    filter_run_chain4_sse(fl[0].stages ? &fl[0] : NULL,
+                          fl[1].stages ? &fl[1] : NULL,
+                          fl[2].stages ? &fl[2] : NULL,
+                          l_in, out ? l_out : NULL, tap ? l_tap : NULL, n);
+
+    scatter_lanes(fl, cc, l_state, MIN(nch, 4));
+    return 0;
+}
+#endif
+
+void
+filter_run_chain(const FilterChain *chain, int nch, FLOAT **state, FLOAT **in,
+                 FLOAT **out, FLOAT **tap, int n)
+{
+#if defined(HAVE_SSE) && !defined(CONFIG_DOUBLE)
+    if (cpu_caps_have_sse()) {
+        int ch, len;
+
+        for (ch = 0; ch < nch; ch += 4) {
+            len = MIN(4, nch - ch);
+            if (filter_run_chain_sse(&chain[ch], len, &state[ch], &in[ch],
+                                     out ? &out[ch] : NULL,
+                                     tap ? &tap[ch] : NULL, n)) {
+                filter_run_chain_c(&chain[ch], len, &state[ch], &in[ch],
+                                   out ? &out[ch] : NULL,
+                                   tap ? &tap[ch] : NULL, n);
+            }
+        }
+        return;
+    }
+#endif
+    filter_run_chain_c(chain, nch, state, in, out, tap, n);
+}
+
+int
+filter_chain_model_init(FilterChainModel *m, const FilterChain *chain, int n,
+                        MemArena *arena)
+{
+    ChainCoefs cc;
+    FLOAT st[FILTER_CHAIN_STATE_SIZE];
+    FLOAT t;
+    int i, j, d;
+
+    memset(m, 0, sizeof(*m));
+    if (chain_get_coefs(chain, &cc))
+        return -1;
+
+    if (cc.pre)
+        m->dims[m->n_dims++] = CHAIN_STATE_PRE;
+    for (j = 0; j < 2*cc.main_stages; j++)
+        m->dims[m->n_dims++] = CHAIN_STATE_MAIN + j;
+    for (j = 0; j < 4*cc.tap_stages; j++)
+        m->dims[m->n_dims++] = CHAIN_STATE_TAP + j;
+
+    m->n = n;
+    m->resp = mem_arena_alloc(arena, FILTER_CHAIN_STATE_SIZE * n * sizeof(FLOAT));
+    if (!m->resp)
+        return -1;
+
+    // state after n samples of silence, starting from each unit state
+    for (d = 0; d < m->n_dims; d++) {
+        memset(st, 0, sizeof(st));
+        st[m->dims[d]] = FCONST(1.0);
+        for (i = 0; i < n; i++)
+            chain_step(&cc, st, 0, &t, 1);
+        for (j = 0; j < m->n_dims; j++)
+            m->phi[m->dims[j]][m->dims[d]] = st[m->dims[j]];
+    }
+
+    // response of the state to an impulse.  the state after n samples is
+    // the dot product of the reversed response with the input.
+    memset(st, 0, sizeof(st));
+    for (i = 0; i < n; i++) {
+        chain_step(&cc, st, i ? 0 : FCONST(1.0), &t, 1);
+        for (d = 0; d < m->n_dims; d++)
+            m->resp[m->dims[d]*n + n-1-i] = st[m->dims[d]];
+    }
+
+    // The filters forget their input after a few hundred samples at most.
+    // Dropping the tail of the response keeps the dot products short, and
+    // avoids slow arithmetic on denormals.
+    for (d = 0; d < m->n_dims; d++) {
+        FLOAT *r = &m->resp[m->dims[d]*n];
+        FLOAT rmax = 0;
+        for (i = 0; i < n; i++)
+            rmax = MAX(rmax, AFT_FABS(r[i]));
+        for (i = 0; i < n && AFT_FABS(r[i]) < rmax * FCONST(1e-10); i++)
+            r[i] = 0;
+        m->start[m->dims[d]] = i & ~3;
+        for (j = 0; j < m->n_dims; j++) {
+            if (AFT_FABS(m->phi[m->dims[j]][m->dims[d]]) < FCONST(1e-20))
+                m->phi[m->dims[j]][m->dims[d]] = 0;
+        }
+    }
+    return 0;
+}
+
 void
-filter_close(FilterContext *f)
+filter_chain_model_input(const FilterChainModel *m, const FLOAT *in, int pos,
+                         int len, FLOAT *z)
 {
-    if (!f)
+    const FLOAT *r;
+    FLOAT sum[4];
+    int d, i, k;
+
+    for (d = 0; d < m->n_dims; d++) {
+        r = &m->resp[m->dims[d]*m->n + pos];
+        // 4 partial sums, which the compiler can keep in one vector
+        sum[0] = sum[1] = sum[2] = sum[3] = 0;
+        i = MAX(0, m->start[m->dims[d]] - pos);
+        for (; i + 4 <= len; i += 4)
+            for (k = 0; k < 4; k++)
+                sum[k] += r[i+k] * in[i+k];
+        for (; i < len; i++)
+            sum[0] += r[i] * in[i];
+        z[m->dims[d]] += (sum[0] + sum[1]) + (sum[2] + sum[3]);
+    }
+}
+
+void
+filter_chain_model_advance(const FilterChainModel *m, FLOAT *state,
+                           const FLOAT *z)
+{
+    FLOAT tmp[FILTER_CHAIN_STATE_SIZE];
+    FLOAT v;
+    int j, k;
+
+    for (j = 0; j < m->n_dims; j++) {
+        v = z[m->dims[j]];
+        for (k = 0; k < m->n_dims; k++)
+            v += m->phi[m->dims[j]][m->dims[k]] * state[m->dims[k]];
+        tmp[j] = v;
+    }
+    for (j = 0; j < m->n_dims; j++)
+        state[m->dims[j]] = tmp[j];
+}
+
+void
+filter_peaks(const FLOAT *in, FLOAT *peaks, int n, int len)
+{
+    FLOAT peak;
+    int i, j;
+
+#if defined(HAVE_SSE) && !defined(CONFIG_DOUBLE)
+    if (cpu_caps_have_sse()) {
+        filter_peaks_sse(in, peaks, n, len);
         return;
-    if (f->private_context) {
-        free(f->private_context);
-        f->private_context = NULL;
     }
-    f->filter = NULL;
+#endif
+    for (i = 0; i < n; i++) {
+        peak = 0;
+        for (j = 0; j < len; j++)
+            peak = MAX(AFT_FABS(in[j]), peak);
+        peaks[i] = peak;
+        in += len;
+    }
 }
@@ -26,6 +26,12 @@
 #define FILTER_H
 
 #include "common.h"
+#include "cpu_caps.h"
+#include "mem.h"
+
+#if defined(HAVE_MMX) || defined(HAVE_SSE)
+#include "x86/filter.h"
+#endif
 
 enum FilterType {
     FILTER_TYPE_LOWPASS,
@@ -56,10 +62,77 @@ typedef struct {
     int taps;
 } FilterContext;
 
-extern int filter_init(FilterContext *f, enum FilterID id);
+extern int filter_init(FilterContext *f, enum FilterID id, MemArena *arena);
 
 extern void filter_run(FilterContext *f, FLOAT *out, FLOAT *in, int n);
 
-extern void filter_close(FilterContext *f);
+/**
+ * The filters applied to one channel by filter_run_chain(), any of which
+ * may be NULL.  'pre' must be a one-pole filter and 'main' a Direct Form II
+ * biquad; they are applied in that order.  'tap' must be a Direct Form I
+ * biquad, and filters the output of the first two into a separate output.
+ * The filter contexts only provide the coefficients; the running state of
+ * a chain is kept by the caller, so several frames can be filtered at once.
+ */
+typedef struct FilterChain {
+    FilterContext *pre;
+    FilterContext *main;
+    FilterContext *tap;
+} FilterChain;
+
+/**
+ * Number of values in the state of one filter chain: the last output of
+ * 'pre', s1 and s2 of each 'main' stage, then s1 to s4 of each 'tap' stage.
+ */
+#define FILTER_CHAIN_STATE_SIZE 13
+
+/**
+ * Run a filter chain on each of 'nch' channels.  All filters are applied
+ * to each sample before moving on to the next one.
+ * @param state  chain state of each channel, updated after the run
+ * @param in     input samples for each channel
+ * @param out    output of pre and main, or NULL.  may be the same as 'in'.
+ * @param tap    output of the tap filter, or NULL.  Channels without a tap
+ *               filter get a copy of 'out'.
+ */
+extern void filter_run_chain(const FilterChain *chain, int nch, FLOAT **state,
+                             FLOAT **in, FLOAT **out, FLOAT **tap, int n);
+
+/**
+ * Linear model of a filter chain over a fixed number of samples, used to
+ * find the chain state at the end of a frame without filtering it in order.
+ * Ignoring the output clipping, the state after n samples is
+ * phi * (state before) + (state reached from zero state by the input).
+ */
+typedef struct FilterChainModel {
+    int n;
+    int n_dims;                     ///< number of state values in use
+    int dims[FILTER_CHAIN_STATE_SIZE];
+    int start[FILTER_CHAIN_STATE_SIZE];     ///< first non-negligible value of resp
+    FLOAT phi[FILTER_CHAIN_STATE_SIZE][FILTER_CHAIN_STATE_SIZE];
+    FLOAT *resp;                    ///< time-reversed response of each state value to an impulse
+} FilterChainModel;
+
+extern int filter_chain_model_init(FilterChainModel *m,
+                                   const FilterChain *chain, int n,
+                                   MemArena *arena);
+
+/**
+ * Add the contribution of 'len' input samples, starting 'pos' samples
+ * into the modelled span, to the zero-state response 'z'.
+ */
+extern void filter_chain_model_input(const FilterChainModel *m,
+                                     const FLOAT *in, int pos, int len,
+                                     FLOAT *z);
+
+/** state = phi * state + z */
+extern void filter_chain_model_advance(const FilterChainModel *m,
+                                       FLOAT *state, const FLOAT *z);
+
+/**
+ * Find the peak absolute value of each of 'n' groups of 'len' samples.
+ * 'len' must be a multiple of 4.
+ */
+extern void filter_peaks(const FLOAT *in, FLOAT *peaks, int n, int len);
 
 #endif /* FILTER_H */
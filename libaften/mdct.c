@@ -44,14 +44,15 @@
 
 /**
  * Allocates and initializes lookup tables in the MDCT context.
- * @param mdct  The MDCT context
- * @param n     Number of time-domain samples used in the MDCT transform
+ * @param mdct   The MDCT context
+ * @param n      Number of time-domain samples used in the MDCT transform
+ * @param arena  Arena the tables are allocated from
  */
 void
-mdct_ctx_init(MDCTContext *mdct, int n)
+mdct_ctx_init(MDCTContext *mdct, int n, MemArena *arena)
 {
-    int *bitrev = aligned_malloc((n/4) * sizeof(int));
-    FLOAT *trig = aligned_malloc((n+n/4) * sizeof(FLOAT));
+    int *bitrev = mem_arena_alloc(arena, (n/4) * sizeof(int));
+    FLOAT *trig = mem_arena_alloc(arena, (n+n/4) * sizeof(FLOAT));
     int i;
     int n2 = (n >> 1);
     int log2n = mdct->log2n = log2i(n);
@@ -91,55 +92,12 @@ mdct_ctx_init(MDCTContext *mdct, int n)
     mdct->scale = FCONST(-2.0) / n;
 }
 
-/** Deallocates memory use by the lookup tables in the MDCT context. */
-static void
-mdct_ctx_close(MDCTContext *mdct)
-{
-    if (mdct) {
-        if (mdct->trig)
-            aligned_free(mdct->trig);
-        if (mdct->bitrev)
-            aligned_free(mdct->bitrev);
-#ifndef CONFIG_DOUBLE
-#ifdef HAVE_SSE
-        if (mdct->trig_bitreverse)
-            aligned_free(mdct->trig_bitreverse);
-        if (mdct->trig_forward)
-            aligned_free(mdct->trig_forward);
-        if (mdct->trig_butterfly_first)
-            aligned_free(mdct->trig_butterfly_first);
-        if (mdct->trig_butterfly_generic8)
-            aligned_free(mdct->trig_butterfly_generic8);
-        if (mdct->trig_butterfly_generic16)
-            aligned_free(mdct->trig_butterfly_generic16);
-        if (mdct->trig_butterfly_generic32)
-            aligned_free(mdct->trig_butterfly_generic32);
-        if (mdct->trig_butterfly_generic64)
-            aligned_free(mdct->trig_butterfly_generic64);
-#endif
-#endif
-        memset(mdct, 0, sizeof(MDCTContext));
-    }
-}
-
 /** Allocates internal buffers for MDCT calculation. */
 static void
-mdct_tctx_init(MDCTThreadContext *tmdct, int n)
+mdct_tctx_init(MDCTThreadContext *tmdct, int n, MemArena *arena)
 {
-    tmdct->buffer  = aligned_malloc((n+2) * sizeof(FLOAT)); /* +2 to prevent illegal read in bitreverse */
-    tmdct->buffer1 = aligned_malloc( n    * sizeof(FLOAT));
-}
-
-/** Deallocates internal buffers for MDCT calculation. */
-static void
-tctx_close(MDCTThreadContext *tmdct)
-{
-    if (tmdct) {
-        if(tmdct->buffer)
-            aligned_free(tmdct->buffer);
-        if(tmdct->buffer1)
-            aligned_free(tmdct->buffer1);
-    }
+    tmdct->buffer  = mem_arena_alloc(arena, (n+2) * sizeof(FLOAT)); /* +2 to prevent illegal read in bitreverse */
+    tmdct->buffer1 = mem_arena_alloc(arena,  n    * sizeof(FLOAT));
 }
 
 /** 8 point butterfly (in place, 4 register) */
@@ -555,47 +513,6 @@ mdct_256(A52ThreadContext *tctx, FLOAT *out, FLOAT *in)
 }
 #endif
 
-static void
-alloc_block_buffers(A52ThreadContext *tctx)
-{
-    A52Frame *frame = &tctx->frame;
-    int i, j;
-
-    // we alloced one continous block and
-    // now interleave in and out buffers
-    for (i = 0; i < A52_NUM_BLOCKS; i++) {
-        if (i) {
-            frame->blocks[i].input_samples[0] =
-                frame->blocks[i-1].input_samples[A52_MAX_CHANNELS-1] + 512 + 256;
-        }
-        frame->blocks[i].mdct_coef[0] =
-            frame->blocks[i].input_samples[0] + 512;
-
-        for (j = 1; j < A52_MAX_CHANNELS; j++) {
-            frame->blocks[i].input_samples[j] =
-                frame->blocks[i].input_samples[j-1] + 512 + 256;
-            frame->blocks[i].mdct_coef[j] =
-                frame->blocks[i].mdct_coef[j-1] + 512 + 256;
-        }
-    }
-}
-
-void
-mdct_close(A52Context *ctx)
-{
-    mdct_ctx_close(&ctx->mdct_ctx_512);
-    mdct_ctx_close(&ctx->mdct_ctx_256);
-}
-
-void
-mdct_thread_close(A52ThreadContext *tctx)
-{
-    tctx_close(&tctx->mdct_tctx_512);
-    tctx_close(&tctx->mdct_tctx_256);
-
-    aligned_free(tctx->frame.blocks[0].input_samples[0]);
-}
-
 void
 mdct_init(A52Context *ctx)
 {
@@ -620,8 +537,8 @@ mdct_init(A52Context *ctx)
 #endif
 #endif /* CONFIG_DOUBLE */
 
-    mdct_ctx_init(&ctx->mdct_ctx_512, 512);
-    mdct_ctx_init(&ctx->mdct_ctx_256, 256);
+    mdct_ctx_init(&ctx->mdct_ctx_512, 512, ctx->arena);
+    mdct_ctx_init(&ctx->mdct_ctx_256, 256, ctx->arena);
 
     ctx->mdct_ctx_512.mdct = mdct_512;
     ctx->mdct_ctx_256.mdct = mdct_256;
@@ -630,13 +547,9 @@ mdct_init(A52Context *ctx)
 void
 mdct_thread_init(A52ThreadContext *tctx)
 {
-    mdct_tctx_init(&tctx->mdct_tctx_512, 512);
-    mdct_tctx_init(&tctx->mdct_tctx_256, 256);
+    mdct_tctx_init(&tctx->mdct_tctx_512, 512, tctx->ctx->arena);
+    mdct_tctx_init(&tctx->mdct_tctx_256, 256, tctx->ctx->arena);
 
     tctx->mdct_tctx_512.mdct = &tctx->ctx->mdct_ctx_512;
     tctx->mdct_tctx_256.mdct = &tctx->ctx->mdct_ctx_256;
-
-    tctx->frame.blocks[0].input_samples[0] =
-        aligned_malloc(A52_NUM_BLOCKS * A52_MAX_CHANNELS * (256 + 512) * sizeof(FLOAT));
-    alloc_block_buffers(tctx);
 }
@@ -41,6 +41,7 @@
 #define MDCT_H
 
 #include "common.h"
+#include "mem.h"
 
 #if defined(HAVE_MMX) || defined(HAVE_SSE)
 #include "x86/mdct.h"
@@ -85,13 +86,11 @@ typedef struct MDCTContext {
 typedef struct {
     MDCTContext *mdct;
     FLOAT *buffer;
-    FLOAT *buffer1;
+    FLOAT *buffer1; ///< transform input: windowed block for 512, reordered half-block for 256
 } MDCTThreadContext;
 
-extern void mdct_ctx_init(MDCTContext *mdct, int n);
+extern void mdct_ctx_init(MDCTContext *mdct, int n, MemArena *arena);
 extern void mdct_init(struct A52Context *ctx);
-extern void mdct_close(struct A52Context *ctx);
 extern void mdct_thread_init(struct A52ThreadContext *tctx);
-extern void mdct_thread_close(struct A52ThreadContext *tctx);
 
 #endif /* MDCT_H */
@@ -0,0 +1,159 @@
+/**
+ * Aften: A/52 audio encoder
+ *
+ * Arena allocator
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file mem.c
+ * Arena allocator for encoder contexts
+ */
+
+// MAP_ANONYMOUS and MADV_HUGEPAGE are hidden by _XOPEN_SOURCE alone
+#define _DEFAULT_SOURCE
+
+#include "common.h"
+#include "mem.h"
+
+#ifdef HAVE_MADV_HUGEPAGE
+#include <sys/mman.h>
+
+#define HUGE_PAGE_SIZE (2 << 20)
+#endif
+
+/** minimum size of the blocks added when the first one runs out */
+#define MEM_ARENA_MIN_BLOCK (64 * 1024)
+
+#define ARENA_ALIGN_UP(x) \
+    (((x) + MEM_ARENA_ALIGN - 1) & ~(size_t)(MEM_ARENA_ALIGN - 1))
+
+typedef struct MemBlock {
+    struct MemBlock *next;
+    void *mem;          ///< start of the underlying allocation
+    size_t size;        ///< usable bytes, counted from the block header
+    size_t used;
+    int mapped;         ///< allocated with mmap() instead of calloc()
+} MemBlock;
+
+struct MemArena {
+    MemBlock *blocks;   ///< newest block first
+    int huge_pages;
+};
+
+static MemBlock *
+block_alloc(size_t size, int huge_pages)
+{
+    MemBlock *b;
+    void *mem = NULL;
+    int mapped = 0;
+
+#ifdef HAVE_MADV_HUGEPAGE
+    if (huge_pages) {
+        size = (size + HUGE_PAGE_SIZE - 1) & ~(size_t)(HUGE_PAGE_SIZE - 1);
+        mem = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mem == MAP_FAILED) {
+            mem = NULL;
+        } else {
+            // only a hint, the kernel may still use normal pages
+            madvise(mem, size, MADV_HUGEPAGE);
+            mapped = 1;
+        }
+    }
+#else
+    (void)huge_pages;
+#endif
+    if (!mem) {
+        mem = calloc(size + MEM_ARENA_ALIGN, 1);
+        if (!mem)
+            return NULL;
+    }
+
+    b = (MemBlock *)ARENA_ALIGN_UP((uintptr_t)mem);
+    b->next = NULL;
+    b->mem = mem;
+    b->size = size;
+    b->used = ARENA_ALIGN_UP(sizeof(MemBlock));
+    b->mapped = mapped;
+    return b;
+}
+
+static void
+block_free(MemBlock *b)
+{
+#ifdef HAVE_MADV_HUGEPAGE
+    if (b->mapped) {
+        munmap(b->mem, b->size);
+        return;
+    }
+#endif
+    free(b->mem);
+}
+
+MemArena *
+mem_arena_create(size_t size, int huge_pages)
+{
+    MemArena *arena;
+    MemBlock *b;
+
+    b = block_alloc(ARENA_ALIGN_UP(sizeof(MemBlock)) +
+                    ARENA_ALIGN_UP(sizeof(MemArena)) + ARENA_ALIGN_UP(size),
+                    huge_pages);
+    if (!b)
+        return NULL;
+
+    // the arena header lives in its own first block
+    arena = (MemArena *)((uint8_t *)b + b->used);
+    b->used += ARENA_ALIGN_UP(sizeof(MemArena));
+    arena->blocks = b;
+    arena->huge_pages = huge_pages;
+    return arena;
+}
+
+void *
+mem_arena_alloc(MemArena *arena, size_t size)
+{
+    MemBlock *b = arena->blocks;
+    void *p;
+
+    size = ARENA_ALIGN_UP(size);
+    if (b->size - b->used < size) {
+        b = block_alloc(MAX(ARENA_ALIGN_UP(sizeof(MemBlock)) + size,
+                            MEM_ARENA_MIN_BLOCK), arena->huge_pages);
+        if (!b)
+            return NULL;
+        b->next = arena->blocks;
+        arena->blocks = b;
+    }
+    p = (uint8_t *)b + b->used;
+    b->used += size;
+    return p;
+}
+
+void
+mem_arena_destroy(MemArena *arena)
+{
+    MemBlock *b, *next;
+
+    if (!arena)
+        return;
+    for (b = arena->blocks; b; b = next) {
+        next = b->next;
+        block_free(b);
+    }
+}
@@ -69,4 +69,28 @@ aligned_free(void *ptr)
 
 #endif /* HAVE_POSIX_MEMALIGN */
 
+/** alignment of every allocation made from a MemArena */
+#define MEM_ARENA_ALIGN 64
+
+typedef struct MemArena MemArena;
+
+/**
+ * Creates an arena which hands out zeroed, 64-byte aligned memory that is
+ * only released all at once by mem_arena_destroy().  The first block is
+ * sized up front; more blocks are added only if it runs out.
+ * @param size        expected total size of all allocations
+ * @param huge_pages  back the arena with transparent huge pages if possible
+ * @return the arena, or NULL on failure
+ */
+extern MemArena *mem_arena_create(size_t size, int huge_pages);
+
+/**
+ * Allocates zeroed memory from the arena.
+ * @return pointer aligned to MEM_ARENA_ALIGN, or NULL on failure
+ */
+extern void *mem_arena_alloc(MemArena *arena, size_t size);
+
+/** Releases the arena and every allocation made from it. */
+extern void mem_arena_destroy(MemArena *arena);
+
 #endif /* MEM_H */
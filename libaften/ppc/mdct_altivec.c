@@ -698,8 +698,8 @@ mdct_256_altivec(A52ThreadContext *tctx, FLOAT *out, FLOAT *in)
 void
 mdct_init_altivec(A52Context *ctx)
 {
-    mdct_ctx_init(&ctx->mdct_ctx_512, 512);
-    mdct_ctx_init(&ctx->mdct_ctx_256, 256);
+    mdct_ctx_init(&ctx->mdct_ctx_512, 512, ctx->arena);
+    mdct_ctx_init(&ctx->mdct_ctx_256, 256, ctx->arena);
 
     ctx->mdct_ctx_512.mdct = mdct_512_altivec;
     ctx->mdct_ctx_256.mdct = mdct_256_altivec;
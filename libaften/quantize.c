@@ -0,0 +1,192 @@
+/**
+ * Aften: A/52 audio encoder
+ * Copyright (c) 2006 Justin Ruggles
+ *
+ * Based on "The simplest AC3 encoder" from FFmpeg
+ * Copyright (c) 2000 Fabrice Bellard.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file quantize.c
+ * A/52 mantissa quantization
+ */
+
+#include "a52enc.h"
+#include "cpu_caps.h"
+
+/**
+ * Mantissa quantizer parameters, indexed by bap value.
+ * With m being the 24-bit coefficient normalized by its exponent, the
+ * quantized value is ((((mul * m) >> shift) + round) >> 1) + offset, clipped
+ * to [min,max].  Symmetric quantizers round to 'levels' levels using
+ * mul=levels, asymmetric quantizers take the top qbits of m using mul=2.
+ */
+typedef struct A52QuantParams {
+    int mul, shift, round, offset, min, max;
+} A52QuantParams;
+
+static const A52QuantParams quant_tab[16] = {
+    {  0, 24, 0, 0,      0,     0 },
+    {  3, 24, 1, 1,      0,     2 },
+    {  5, 24, 1, 2,      0,     4 },
+    {  7, 24, 1, 3,      0,     6 },
+    { 11, 24, 1, 5,      0,    10 },
+    { 15, 24, 1, 7,      0,    14 },
+    {  2, 20, 0, 0,    -16,    15 },
+    {  2, 19, 0, 0,    -32,    31 },
+    {  2, 18, 0, 0,    -64,    63 },
+    {  2, 17, 0, 0,   -128,   127 },
+    {  2, 16, 0, 0,   -256,   255 },
+    {  2, 15, 0, 0,   -512,   511 },
+    {  2, 14, 0, 0,  -1024,  1023 },
+    {  2, 13, 0, 0,  -2048,  2047 },
+    {  2, 11, 0, 0,  -8192,  8191 },
+    {  2,  9, 0, 0, -32768, 32767 }
+};
+
+static void
+quantize_mantissas_ch(FLOAT *mdct_coef, uint8_t *exp, uint8_t *bap,
+                      uint16_t *qmant, int ncoefs)
+{
+    const A52QuantParams *q;
+    int i, m, v;
+
+    for (i = 0; i < ncoefs; i++) {
+        q = &quant_tab[bap[i]];
+        // |m| < 2^24 since the exponent is never larger than the one
+        // extracted from the coefficient
+        m = (int)(mdct_coef[i] * (1 << 24)) * (1 << exp[i]);
+        v = ((((q->mul * m) >> q->shift) + q->round) >> 1) + q->offset;
+        qmant[i] = CLIP(v, q->min, q->max);
+    }
+}
+
+/** number of bits written for each bap value */
+static const uint8_t mant_bits_tab[16] = {
+    0, 5, 7, 3, 7, 4, 5, 6, 7, 8, 9, 10, 11, 12, 14, 16
+};
+
+/** mantissa group index for bap 1, 2 and 4, -1 for ungrouped values */
+static const int8_t grp_idx_tab[16] = {
+    -1, 0, 1, -1, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+};
+
+/** group sizes, code sizes and weights of each mantissa within a group */
+static const int grp_size_tab[3] = { 3, 3, 2 };
+static const int grp_bits_tab[3] = { 5, 7, 7 };
+static const int grp_mul_tab[3][3] = { { 9, 3, 1 }, { 25, 5, 1 }, { 11, 1, 0 } };
+
+/**
+ * The 3-level, 5-level and 11-level groups which are still open.  The
+ * first mantissa of a group reserves the bits for the group code, which
+ * is filled in when the group is complete.
+ */
+typedef struct A52MantGroups {
+    uint32_t pos[3];
+    int code[3];
+    int cnt[3];
+} A52MantGroups;
+
+static inline void
+put_mantissa(BitWriter *bw, int bits, uint32_t val, int checked)
+{
+    if (checked)
+        bitwriter_writebits(bw, bits, val);
+    else
+        bitwriter_writebits_unchecked(bw, bits, val & ((1U << bits) - 1));
+}
+
+static inline void
+write_mantissas_ch(BitWriter *bw, A52MantGroups *grp, uint16_t *qmant,
+                   uint8_t *bap, int ncoefs, int checked)
+{
+    int i, g, n;
+
+    for (i = 0; i < ncoefs; i++) {
+        g = grp_idx_tab[bap[i]];
+        if (g < 0) {
+            put_mantissa(bw, mant_bits_tab[bap[i]], qmant[i], checked);
+            continue;
+        }
+        n = grp->cnt[g];
+        if (!n) {
+            grp->pos[g] = bitwriter_bitcount(bw);
+            grp->code[g] = 0;
+            put_mantissa(bw, grp_bits_tab[g], 0, checked);
+        }
+        grp->code[g] += qmant[i] * grp_mul_tab[g][n];
+        if (++n == grp_size_tab[g]) {
+            bitwriter_patchbits(bw, grp->pos[g], grp_bits_tab[g],
+                                grp->code[g]);
+            n = 0;
+        }
+        grp->cnt[g] = n;
+    }
+}
+
+/**
+ * Quantizes the mantissas of all channels in a block and writes them.
+ * Each channel is quantized into a small local buffer and written right
+ * away.  Groups span channel boundaries, and a group which is incomplete at
+ * the end of the block is padded with zero mantissas.
+ */
+void
+a52_output_mantissas(A52ThreadContext *tctx, A52Block *block)
+{
+    A52Context *ctx = tctx->ctx;
+    A52Frame *frame = &tctx->frame;
+    A52MantGroups grp;
+    BitWriter pb;
+    uint16_t qmant[256];
+    int ch, g;
+
+    memset(&grp, 0, sizeof(grp));
+    for (ch = 0; ch < ctx->n_all_channels; ch++) {
+        ctx->quantf.quantize_mantissas_ch(block->mdct_coef[ch],
+                                          block->exp[ch], block->bap[ch],
+                                          qmant, frame->ncoefs[ch]);
+        if (bitwriter_has_room(&tctx->bw, frame->ncoefs[ch] * 16)) {
+            // no overflow is possible, write without buffer checks using a
+            // local copy of the bit writer which can stay in registers
+            pb = tctx->bw;
+            write_mantissas_ch(&pb, &grp, qmant, block->bap[ch],
+                               frame->ncoefs[ch], 0);
+            tctx->bw = pb;
+        } else {
+            write_mantissas_ch(&tctx->bw, &grp, qmant, block->bap[ch],
+                               frame->ncoefs[ch], 1);
+        }
+    }
+    for (g = 0; g < 3; g++) {
+        if (grp.cnt[g]) {
+            bitwriter_patchbits(&tctx->bw, grp.pos[g], grp_bits_tab[g],
+                                grp.code[g]);
+        }
+    }
+}
+
+void
+quantize_init(A52QuantizeFunctions *quantf)
+{
+    quantf->quantize_mantissas_ch = quantize_mantissas_ch;
+#ifdef HAVE_SSE2
+    if (cpu_caps_have_sse2()) {
+        quantize_init_sse2();
+        quantf->quantize_mantissas_ch = quantize_mantissas_ch_sse2;
+    }
+#endif /* HAVE_SSE2 */
+}
@@ -0,0 +1,53 @@
+/**
+ * Aften: A/52 audio encoder
+ * Copyright (c) 2006 Justin Ruggles
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file quantize.h
+ * A/52 mantissa quantization header
+ */
+
+#ifndef QUANTIZE_H
+#define QUANTIZE_H
+
+#include "common.h"
+
+#if defined(HAVE_MMX) || defined(HAVE_SSE)
+#include "x86/quantize.h"
+#endif
+
+struct A52ThreadContext;
+struct A52Block;
+
+typedef struct A52QuantizeFunctions {
+
+    /**
+     * Quantize the mantissas of one channel in a block according to the bit
+     * allocation pointers.  Values for bap 1, 2 and 4 are left ungrouped.
+     */
+    void (*quantize_mantissas_ch)(FLOAT *mdct_coef, uint8_t *exp, uint8_t *bap,
+                                  uint16_t *qmant, int ncoefs);
+
+} A52QuantizeFunctions;
+
+extern void quantize_init(A52QuantizeFunctions *quantf);
+
+extern void a52_output_mantissas(struct A52ThreadContext *tctx,
+                                 struct A52Block *block);
+
+#endif /* QUANTIZE_H */
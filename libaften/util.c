@@ -119,25 +119,9 @@ aften_wav_channels_to_acmod(int ch, unsigned int chmask, int *acmod, int *lfe)
 }
 
 /**
- * WAV to A/52 channel mapping
- * note: thanks to Tebasuna for help in getting this order right.
+ * WAV to A/52 channel mapping, see a52_wav_chmap
  */
 
-/**
- * Table to remap channels from WAV order to A/52 order.
- * [acmod][lfe][ch]
- */
-static const uint8_t wav_chmap[8][2][6] = {
-    { { 0, 1,          }, { 0, 1, 2,         } },
-    { { 0,             }, { 0, 1,            } },
-    { { 0, 1,          }, { 0, 1, 2,         } },
-    { { 0, 2, 1,       }, { 0, 2, 1, 3,      } },
-    { { 0, 1, 2,       }, { 0, 1, 3, 2,      } },
-    { { 0, 2, 1, 3,    }, { 0, 2, 1, 4, 3,   } },
-    { { 0, 1, 2, 3, 4, }, { 0, 1, 3, 4, 2,   } },
-    { { 0, 2, 1, 3, 4, }, { 0, 2, 1, 4, 5, 3 } },
-};
-
 #define REMAP_WAV_TO_A52_COMMON(DATA_TYPE) \
 { \
     int i, j; \
@@ -147,7 +131,7 @@ static const uint8_t wav_chmap[8][2][6] = {
         for (i = 0; i < n*ch; i += ch) { \
             memcpy(tmp, &smp[i], ch*sample_size); \
             for (j = 0; j < ch; j++) \
-                smp[i+j] = tmp[wav_chmap[acmod][lfe][j]]; \
+                smp[i+j] = tmp[a52_wav_chmap[acmod][lfe][j]]; \
         } \
 }
 
@@ -28,12 +28,12 @@
 ALIGN16(FLOAT) a52_window[512] = {0};
 
 static void
-apply_a52_window(FLOAT *samples)
+apply_a52_window(FLOAT *out, const FLOAT *in)
 {
     int i;
     for (i = 0; i < 512; i += 2) {
-        samples[i  ] *= a52_window[i  ];
-        samples[i+1] *= a52_window[i+1];
+        out[i  ] = in[i  ] * a52_window[i  ];
+        out[i+1] = in[i+1] * a52_window[i+1];
     }
 }
 
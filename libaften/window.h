@@ -36,9 +36,10 @@ extern FLOAT a52_window[512];
 
 typedef struct A52WindowFunctions {
     /**
-     * Apply the A/52 window function to 512 input samples.
+     * Apply the A/52 window function to 512 input samples.  The windowed
+     * samples are written to 'out', leaving the input unchanged.
      */
-    void (*apply_a52_window)(FLOAT *samples);
+    void (*apply_a52_window)(FLOAT *out, const FLOAT *in);
 } A52WindowFunctions;
 
 extern void a52_window_init(A52WindowFunctions *winf);
@@ -0,0 +1,50 @@
+/**
+ * Aften: A/52 audio encoder
+ *
+ * x86 input format conversion header
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation;
+ * version 2 of the License
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+/**
+ * @file convert.h
+ * x86 input format conversion header
+ */
+
+#ifndef X86_CONVERT_H
+#define X86_CONVERT_H
+
+#include "common.h"
+
+#if defined(HAVE_SSE2) && !defined(CONFIG_DOUBLE)
+/**
+ * Deinterleave-and-convert functions for 1, 2 or 6 channels.  Other channel
+ * counts must use the C versions.
+ */
+extern void fmt_convert_from_s16_sse2(FLOAT **dest, const void *vsrc,
+                                      int nch, int n);
+extern void fmt_convert_from_s20_sse2(FLOAT **dest, const void *vsrc,
+                                      int nch, int n);
+extern void fmt_convert_from_s24_sse2(FLOAT **dest, const void *vsrc,
+                                      int nch, int n);
+extern void fmt_convert_from_s32_sse2(FLOAT **dest, const void *vsrc,
+                                      int nch, int n);
+extern void fmt_convert_from_float_sse2(FLOAT **dest, const void *vsrc,
+                                        int nch, int n);
+#endif
+
+#endif /* X86_CONVERT_H */
@@ -0,0 +1,90 @@
+/**
+ * Aften: A/52 audio encoder
+ *
+ * SSE2 input format conversion
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation;
+ * version 2 of the License
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+/**
+ * @file convert_sse2.c
+ * SSE2 deinterleave and conversion of interleaved input to planar FLOAT
+ *
+ * The kernels are shared with the PCM library, see deinterleave_sse2.h.
+ * All input scales are powers of two, so multiplying by the reciprocal
+ * gives the same result as the division in the C versions.
+ */
+
+#include "a52enc.h"
+#include "x86/convert.h"
+#include "deinterleave_sse2.h"
+
+#ifndef CONFIG_DOUBLE
+
+/* each channel count gets its own copy of the loop, with nch constant */
+
+void
+fmt_convert_from_s16_sse2(FLOAT **dest, const void *vsrc, int nch, int n)
+{
+    const float scale = 1.0f / 32768.0f;
+
+    switch (nch) {
+    case 1: deinterleave_s16_sse2(dest, vsrc, 1, n, scale); break;
+    case 2: deinterleave_s16_sse2(dest, vsrc, 2, n, scale); break;
+    case 6: deinterleave_s16_sse2(dest, vsrc, 6, n, scale); break;
+    }
+}
+
+static inline void
+convert_s32_nch(FLOAT **dest, const void *vsrc, int nch, int n, float scale)
+{
+    switch (nch) {
+    case 1: deinterleave_s32_sse2(dest, vsrc, 1, n, scale); break;
+    case 2: deinterleave_s32_sse2(dest, vsrc, 2, n, scale); break;
+    case 6: deinterleave_s32_sse2(dest, vsrc, 6, n, scale); break;
+    }
+}
+
+void
+fmt_convert_from_s20_sse2(FLOAT **dest, const void *vsrc, int nch, int n)
+{
+    convert_s32_nch(dest, vsrc, nch, n, 1.0f / 524288.0f);
+}
+
+void
+fmt_convert_from_s24_sse2(FLOAT **dest, const void *vsrc, int nch, int n)
+{
+    convert_s32_nch(dest, vsrc, nch, n, 1.0f / 8388608.0f);
+}
+
+void
+fmt_convert_from_s32_sse2(FLOAT **dest, const void *vsrc, int nch, int n)
+{
+    convert_s32_nch(dest, vsrc, nch, n, 1.0f / 2147483648.0f);
+}
+
+void
+fmt_convert_from_float_sse2(FLOAT **dest, const void *vsrc, int nch, int n)
+{
+    switch (nch) {
+    case 1: deinterleave_float_sse2(dest, vsrc, 1, n); break;
+    case 2: deinterleave_float_sse2(dest, vsrc, 2, n); break;
+    case 6: deinterleave_float_sse2(dest, vsrc, 6, n); break;
+    }
+}
+
+#endif /* CONFIG_DOUBLE */
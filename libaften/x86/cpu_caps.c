@@ -30,6 +30,7 @@
 
 /* caps2 */
 #define SSE3_BIT             0
+#define PCLMUL_BIT           1
 #define SSSE3_BIT            9
 
 /* caps3 */
@@ -104,9 +105,9 @@ static void cpu_caps_detect_x86(uint32_t *caps1, uint32_t *caps2, uint32_t *caps
 #endif
 #endif
 
-static struct x86cpu_caps_s x86cpu_caps_compile = { 0, 0, 0, 0, 0, 0, 0, 0, 0};
-static struct x86cpu_caps_s x86cpu_caps_detect = { 1, 1, 1, 1, 1, 1, 1, 1, 1};
-struct x86cpu_caps_s x86cpu_caps_use = { 0, 0, 0, 0, 0, 0, 0, 0, 0};
+static struct x86cpu_caps_s x86cpu_caps_compile = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+static struct x86cpu_caps_s x86cpu_caps_detect = { 1, 1, 1, 1, 1, 1, 1, 1, 1, 1};
+struct x86cpu_caps_s x86cpu_caps_use = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
 
 void cpu_caps_detect(void)
 {
@@ -126,6 +127,9 @@ void cpu_caps_detect(void)
 #ifdef HAVE_SSSE3
     x86cpu_caps_compile.ssse3 = 1;
 #endif
+#ifdef HAVE_PCLMUL
+    x86cpu_caps_compile.pclmul = 1;
+#endif
 #ifdef HAVE_3DNOW
     x86cpu_caps_compile.amd_3dnow = 1;
 #endif
@@ -150,6 +154,9 @@ void cpu_caps_detect(void)
 
         x86cpu_caps_detect.sse3         = (caps2 >> SSE3_BIT) & 1;
         x86cpu_caps_detect.ssse3        = (caps2 >> SSSE3_BIT) & 1;
+        /* the PCLMULQDQ code also uses SSSE3 byte shuffles */
+        x86cpu_caps_detect.pclmul       = (caps2 >> PCLMUL_BIT) & 1 &
+                                          x86cpu_caps_detect.ssse3;
 
         x86cpu_caps_detect.amd_3dnow    = (caps3 >> AMD_3DNOW_BIT) & 1;
         x86cpu_caps_detect.amd_3dnowext = (caps3 >> AMD_3DNOWEXT_BIT) & 1;
@@ -167,6 +174,7 @@ void cpu_caps_detect(void)
     x86cpu_caps_use.sse2         = x86cpu_caps_detect.sse2         & x86cpu_caps_compile.sse2;
     x86cpu_caps_use.sse3         = x86cpu_caps_detect.sse3         & x86cpu_caps_compile.sse3;
     x86cpu_caps_use.ssse3        = x86cpu_caps_detect.ssse3        & x86cpu_caps_compile.ssse3;
+    x86cpu_caps_use.pclmul       = x86cpu_caps_detect.pclmul       & x86cpu_caps_compile.pclmul;
     x86cpu_caps_use.amd_3dnow    = x86cpu_caps_detect.amd_3dnow    & x86cpu_caps_compile.amd_3dnow;
     x86cpu_caps_use.amd_3dnowext = x86cpu_caps_detect.amd_3dnowext & x86cpu_caps_compile.amd_3dnowext;
     x86cpu_caps_use.amd_sse_mmx  = x86cpu_caps_detect.amd_sse_mmx  & x86cpu_caps_compile.amd_sse_mmx;
@@ -179,6 +187,7 @@ void apply_simd_restrictions(AftenSimdInstructions *simd_instructions)
     x86cpu_caps_use.sse2         &= simd_instructions->sse2;
     x86cpu_caps_use.sse3         &= simd_instructions->sse3;
     x86cpu_caps_use.ssse3        &= simd_instructions->ssse3;
+    x86cpu_caps_use.pclmul       &= simd_instructions->pclmul;
     x86cpu_caps_use.amd_3dnow    &= simd_instructions->amd_3dnow;
     x86cpu_caps_use.amd_3dnowext &= simd_instructions->amd_3dnowext;
     x86cpu_caps_use.amd_sse_mmx  &= simd_instructions->amd_sse_mmx;
@@ -33,6 +33,7 @@ struct x86cpu_caps_s {
     int sse2;
     int sse3;
     int ssse3;
+    int pclmul;
     int amd_3dnow;
     int amd_3dnowext;
     int amd_sse_mmx;
@@ -49,6 +50,7 @@ static inline int cpu_caps_have_sse(void);
 static inline int cpu_caps_have_sse2(void);
 static inline int cpu_caps_have_sse3(void);
 static inline int cpu_caps_have_ssse3(void);
+static inline int cpu_caps_have_pclmul(void);
 static inline int cpu_caps_have_3dnow(void);
 static inline int cpu_caps_have_3dnowext(void);
 static inline int cpu_caps_have_ssemmx(void);
@@ -79,6 +81,11 @@ static inline int cpu_caps_have_ssse3(void)
     return x86cpu_caps_use.ssse3;
 }
 
+static inline int cpu_caps_have_pclmul(void)
+{
+    return x86cpu_caps_use.pclmul;
+}
+
 static inline int cpu_caps_have_3dnow(void)
 {
     return x86cpu_caps_use.amd_3dnow;
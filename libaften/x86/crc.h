@@ -0,0 +1,39 @@
+/**
+ * Aften: A/52 audio encoder
+ *
+ * x86 CRC functions header
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation;
+ * version 2 of the License
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+/**
+ * @file crc.h
+ * A/52 x86 CRC header
+ */
+
+#ifndef X86_CRC_H
+#define X86_CRC_H
+
+#include "common.h"
+
+#ifdef HAVE_PCLMUL
+extern void crc_init_pclmul(uint32_t poly);
+extern void crc16_fold_pclmul(const uint8_t *data, uint32_t len,
+                              uint8_t *folded);
+#endif /* HAVE_PCLMUL */
+
+#endif /* X86_CRC_H */
@@ -0,0 +1,122 @@
+/**
+ * Aften: A/52 audio encoder
+ *
+ * PCLMULQDQ CRC folding
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation;
+ * version 2 of the License
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+/**
+ * @file crc_pclmul.c
+ * CRC-16 folding using carry-less multiplication
+ *
+ * Each 16-byte block is read as a 128-bit polynomial, first bit highest.
+ * A block X followed by d bits of data is congruent modulo the crc
+ * polynomial P to hi(X) * (x^(d+64) mod P) + lo(X) * (x^d mod P), which
+ * fits in 128 bits again.  Folding the whole input this way leaves one
+ * block with the same crc as the input.
+ */
+
+#include "common.h"
+#include "x86/simd_support.h"
+#include "x86/crc.h"
+
+/** fold constants { x^d mod P, x^(d+64) mod P } for d = 128, 256, 384, 512 */
+static ALIGN16(uint64_t) fold_tab[4][2];
+
+static uint32_t
+xpow_mod(int n, uint32_t poly)
+{
+    uint32_t r = 1;
+
+    while (n--) {
+        r <<= 1;
+        if (r & 0x10000)
+            r ^= poly;
+    }
+    return r;
+}
+
+void
+crc_init_pclmul(uint32_t poly)
+{
+    int i;
+
+    for (i = 0; i < 4; i++) {
+        fold_tab[i][0] = xpow_mod(128 * (i+1), poly);
+        fold_tab[i][1] = xpow_mod(128 * (i+1) + 64, poly);
+    }
+}
+
+static inline __m128i
+fold(__m128i x, __m128i k)
+{
+    return _mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x00),
+                         _mm_clmulepi64_si128(x, k, 0x11));
+}
+
+/**
+ * Folds len bytes (a multiple of 16, at least 64) into 16 bytes which
+ * have the same crc.
+ */
+void
+crc16_fold_pclmul(const uint8_t *data, uint32_t len, uint8_t *folded)
+{
+    const __m128i bswap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7,
+                                       8, 9, 10, 11, 12, 13, 14, 15);
+    const __m128i *in = (const __m128i *)data;
+    __m128i k128 = _mm_load_si128((const __m128i *)fold_tab[0]);
+    __m128i k256 = _mm_load_si128((const __m128i *)fold_tab[1]);
+    __m128i k384 = _mm_load_si128((const __m128i *)fold_tab[2]);
+    __m128i k512 = _mm_load_si128((const __m128i *)fold_tab[3]);
+    __m128i x0, x1, x2, x3;
+
+    x0 = _mm_shuffle_epi8(_mm_loadu_si128(in  ), bswap);
+    x1 = _mm_shuffle_epi8(_mm_loadu_si128(in+1), bswap);
+    x2 = _mm_shuffle_epi8(_mm_loadu_si128(in+2), bswap);
+    x3 = _mm_shuffle_epi8(_mm_loadu_si128(in+3), bswap);
+    in += 4;
+    len -= 64;
+
+    // four independent lanes, each folded across 64 bytes
+    while (len >= 64) {
+        x0 = _mm_xor_si128(fold(x0, k512),
+                           _mm_shuffle_epi8(_mm_loadu_si128(in  ), bswap));
+        x1 = _mm_xor_si128(fold(x1, k512),
+                           _mm_shuffle_epi8(_mm_loadu_si128(in+1), bswap));
+        x2 = _mm_xor_si128(fold(x2, k512),
+                           _mm_shuffle_epi8(_mm_loadu_si128(in+2), bswap));
+        x3 = _mm_xor_si128(fold(x3, k512),
+                           _mm_shuffle_epi8(_mm_loadu_si128(in+3), bswap));
+        in += 4;
+        len -= 64;
+    }
+
+    // combine the lanes
+    x0 = _mm_xor_si128(_mm_xor_si128(fold(x0, k384), fold(x1, k256)),
+                       _mm_xor_si128(fold(x2, k128), x3));
+
+    // remaining 16-byte blocks
+    while (len >= 16) {
+        x0 = _mm_xor_si128(fold(x0, k128),
+                           _mm_shuffle_epi8(_mm_loadu_si128(in), bswap));
+        in++;
+        len -= 16;
+    }
+
+    _mm_storeu_si128((__m128i *)folded, _mm_shuffle_epi8(x0, bswap));
+}
@@ -0,0 +1,52 @@
+/**
+ * Aften: A/52 audio encoder
+ *
+ * x86 audio filter header
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation;
+ * version 2 of the License
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+/**
+ * @file filter.h
+ * x86 audio filter header
+ */
+
+#ifndef X86_FILTER_H
+#define X86_FILTER_H
+
+#include "common.h"
+
+#if defined(HAVE_SSE) && !defined(CONFIG_DOUBLE)
+/**
+ * One filter of a chain, for 4 channels in SIMD lanes.  Lanes with
+ * enable[lane] == 0 pass their input through unchanged.
+ */
+typedef struct FilterLanes {
+    int stages;
+    FLOAT enable[4];
+    FLOAT coefs[5][4];
+    FLOAT state[2][5][4];
+} FilterLanes;
+
+extern void filter_run_chain4_sse(FilterLanes *pre, FilterLanes *main,
+                                  FilterLanes *tap, FLOAT **in, FLOAT **out,
+                                  FLOAT **tap_out, int n);
+
+extern void filter_peaks_sse(const FLOAT *in, FLOAT *peaks, int n, int len);
+#endif
+
+#endif /* X86_FILTER_H */
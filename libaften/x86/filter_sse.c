@@ -0,0 +1,268 @@
+/**
+ * Aften: A/52 audio encoder
+ *
+ * SSE multi-channel audio filters
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation;
+ * version 2 of the License
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+/**
+ * @file filter_sse.c
+ * SSE audio filter chain, running 4 channels in parallel
+ *
+ * The filters are recursive, so the samples of one channel can not be
+ * processed in parallel.  Instead each SIMD lane holds one channel.  Input
+ * is loaded 4 samples per channel at a time and transposed so that each
+ * vector holds one time step of all 4 channels.  Each time step then goes
+ * through all filters of the chain while their state stays in registers.
+ * The arithmetic is done in the same order as in the C filters, so the
+ * output is identical.
+ */
+
+#include "filter.h"
+#include "x86/filter.h"
+#include "x86/simd_support.h"
+
+/** filter state and constants of a chain, kept in registers */
+typedef struct ChainRegs {
+    int pre, main, tap;
+    __m128 one, mone;
+    __m128 pre_en, main_en, tap_en;
+    __m128 pre_l;
+    __m128 main_s[2][3];
+    __m128 tap_s[2][5];
+} ChainRegs;
+
+/* same as CLIP(v, -1.0, 1.0), including the handling of NaN */
+static inline __m128
+clip_unity(__m128 v, __m128 one, __m128 mone)
+{
+    return _mm_max_ps(_mm_min_ps(one, v), mone);
+}
+
+static inline __m128
+select_ps(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+static inline __m128
+coef(const FilterLanes *fl, int k)
+{
+    return _mm_loadu_ps(fl->coefs[k]);
+}
+
+/**
+ * Run one time step through the chain.  Returns the main output and stores
+ * the tap output in *t.
+ */
+static inline __m128
+chain_step(ChainRegs *r, const FilterLanes *pre, const FilterLanes *main,
+           const FilterLanes *tap, __m128 x, __m128 *t)
+{
+    __m128 y, v;
+    int j;
+
+    if (r->pre) {
+        // one-pole: coefs are p1 and p
+        v = _mm_add_ps(_mm_mul_ps(coef(pre, 0), x),
+                       _mm_mul_ps(coef(pre, 1), r->pre_l));
+        r->pre_l = clip_unity(v, r->one, r->mone);
+        x = select_ps(r->pre_en, r->pre_l, x);
+    }
+    if (r->main) {
+        // biquad direct form II
+        y = x;
+        for (j = 0; j < 2; j++) {
+            __m128 *s = r->main_s[j];
+            if (j >= main->stages)
+                break;
+            s[0] = y;
+            v = _mm_add_ps(_mm_mul_ps(coef(main, 0), s[0]), s[1]);
+            s[1] = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(coef(main, 1), s[0]),
+                                         _mm_mul_ps(coef(main, 3), v)), s[2]);
+            s[2] = _mm_sub_ps(_mm_mul_ps(coef(main, 2), s[0]),
+                              _mm_mul_ps(coef(main, 4), v));
+            y = clip_unity(v, r->one, r->mone);
+        }
+        x = select_ps(r->main_en, y, x);
+    }
+    if (r->tap) {
+        // biquad direct form I
+        y = x;
+        for (j = 0; j < 2; j++) {
+            __m128 *s = r->tap_s[j];
+            if (j >= tap->stages)
+                break;
+            v = _mm_add_ps(_mm_setzero_ps(), _mm_mul_ps(coef(tap, 0), y));
+            v = _mm_add_ps(v, _mm_mul_ps(coef(tap, 1), s[1]));
+            v = _mm_add_ps(v, _mm_mul_ps(coef(tap, 2), s[2]));
+            v = _mm_sub_ps(v, _mm_mul_ps(coef(tap, 3), s[3]));
+            v = _mm_sub_ps(v, _mm_mul_ps(coef(tap, 4), s[4]));
+            s[2] = s[1];
+            s[4] = s[3];
+            s[1] = y;
+            s[3] = v;
+            y = clip_unity(v, r->one, r->mone);
+        }
+        *t = select_ps(r->tap_en, y, x);
+    } else {
+        *t = x;
+    }
+    return x;
+}
+
+static inline void
+load_transposed(__m128 x[4], FLOAT **in, int i)
+{
+    x[0] = _mm_loadu_ps(in[0] + i);
+    x[1] = _mm_loadu_ps(in[1] + i);
+    x[2] = _mm_loadu_ps(in[2] + i);
+    x[3] = _mm_loadu_ps(in[3] + i);
+    _MM_TRANSPOSE4_PS(x[0], x[1], x[2], x[3]);
+}
+
+static inline void
+store_transposed(FLOAT **out, int i, __m128 x[4])
+{
+    _MM_TRANSPOSE4_PS(x[0], x[1], x[2], x[3]);
+    _mm_storeu_ps(out[0] + i, x[0]);
+    _mm_storeu_ps(out[1] + i, x[1]);
+    _mm_storeu_ps(out[2] + i, x[2]);
+    _mm_storeu_ps(out[3] + i, x[3]);
+}
+
+static inline void
+store_lanes(FLOAT **out, int i, __m128 v)
+{
+    union __m128f u;
+    int k;
+
+    u.v = v;
+    for (k = 0; k < 4; k++)
+        out[k][i] = u.f[k];
+}
+
+static void
+load_state(__m128 *s, const FilterLanes *fl, int j, int n)
+{
+    int k;
+
+    for (k = 0; k < n; k++)
+        s[k] = _mm_loadu_ps(fl->state[j][k]);
+}
+
+static void
+store_state(FilterLanes *fl, int j, const __m128 *s, int n)
+{
+    int k;
+
+    for (k = 0; k < n; k++)
+        _mm_storeu_ps(fl->state[j][k], s[k]);
+}
+
+void
+filter_run_chain4_sse(FilterLanes *pre, FilterLanes *main, FilterLanes *tap,
+                      FLOAT **in, FLOAT **out, FLOAT **tap_out, int n)
+{
+    ChainRegs r;
+    __m128 x[4], t[4];
+    int i, j, k;
+
+    r.pre = pre != NULL;
+    r.main = main != NULL;
+    r.tap = tap != NULL;
+    r.one = _mm_set1_ps(1.0f);
+    r.mone = _mm_set1_ps(-1.0f);
+    r.pre_en = r.main_en = r.tap_en = _mm_setzero_ps();
+    r.pre_l = _mm_setzero_ps();
+    for (j = 0; j < 2; j++) {
+        for (k = 0; k < 3; k++)
+            r.main_s[j][k] = _mm_setzero_ps();
+        for (k = 0; k < 5; k++)
+            r.tap_s[j][k] = _mm_setzero_ps();
+    }
+    if (pre) {
+        r.pre_en = _mm_cmpneq_ps(_mm_loadu_ps(pre->enable), _mm_setzero_ps());
+        r.pre_l = _mm_loadu_ps(pre->state[0][0]);
+    }
+    if (main) {
+        r.main_en = _mm_cmpneq_ps(_mm_loadu_ps(main->enable), _mm_setzero_ps());
+        for (j = 0; j < main->stages; j++)
+            load_state(r.main_s[j], main, j, 3);
+    }
+    if (tap) {
+        r.tap_en = _mm_cmpneq_ps(_mm_loadu_ps(tap->enable), _mm_setzero_ps());
+        for (j = 0; j < tap->stages; j++)
+            load_state(r.tap_s[j], tap, j, 5);
+    }
+
+    for (i = 0; i + 4 <= n; i += 4) {
+        load_transposed(x, in, i);
+        for (k = 0; k < 4; k++)
+            x[k] = chain_step(&r, pre, main, tap, x[k], &t[k]);
+        if (out)
+            store_transposed(out, i, x);
+        if (tap_out)
+            store_transposed(tap_out, i, t);
+    }
+    for (; i < n; i++) {
+        x[0] = _mm_setr_ps(in[0][i], in[1][i], in[2][i], in[3][i]);
+        x[0] = chain_step(&r, pre, main, tap, x[0], &t[0]);
+        if (out)
+            store_lanes(out, i, x[0]);
+        if (tap_out)
+            store_lanes(tap_out, i, t[0]);
+    }
+
+    if (pre)
+        _mm_storeu_ps(pre->state[0][0], r.pre_l);
+    if (main) {
+        for (j = 0; j < main->stages; j++)
+            store_state(main, j, r.main_s[j], 3);
+    }
+    if (tap) {
+        for (j = 0; j < tap->stages; j++) {
+            r.tap_s[j][0] = r.tap_s[j][1];
+            store_state(tap, j, r.tap_s[j], 5);
+        }
+    }
+}
+
+/**
+ * Peak levels, 4 samples at a time.  Like MAX() in the C version,
+ * _mm_max_ps() keeps the running peak when a sample is NaN, and since max
+ * is exact the result does not depend on the order of the samples.
+ */
+void
+filter_peaks_sse(const FLOAT *in, FLOAT *peaks, int n, int len)
+{
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    union __m128f u;
+    __m128 peak;
+    int i, j;
+
+    for (i = 0; i < n; i++) {
+        peak = _mm_setzero_ps();
+        for (j = 0; j < len; j += 4)
+            peak = _mm_max_ps(_mm_andnot_ps(sign, _mm_loadu_ps(in + j)), peak);
+        peak = _mm_max_ps(peak, _mm_movehl_ps(peak, peak));
+        u.v = _mm_max_ss(peak, _mm_shuffle_ps(peak, peak, 1));
+        peaks[i] = u.f[0];
+        in += len;
+    }
+}
@@ -334,9 +334,9 @@ mdct_256_sse(A52ThreadContext *tctx, FLOAT *out, FLOAT *in)
 }
 
 void
-mdct_ctx_init_sse(MDCTContext *mdct, int n)
+mdct_ctx_init_sse(MDCTContext *mdct, int n, MemArena *arena)
 {
-    mdct_ctx_init(mdct, n);
+    mdct_ctx_init(mdct, n, arena);
     {
         __m128  pscalem  = _mm_set_ps1(mdct->scale);
         float *T, *S;
@@ -347,7 +347,7 @@ mdct_ctx_init_sse(MDCTContext *mdct, int n)
         /*
             for mdct_bitreverse
         */
-        T    = aligned_malloc(sizeof(*T)*n2);
+        T    = mem_arena_alloc(arena, sizeof(*T)*n2);
         mdct->trig_bitreverse    = T;
         S    = mdct->trig+n;
         for (i = 0; i < n4; i += 8) {
@@ -367,7 +367,7 @@ mdct_ctx_init_sse(MDCTContext *mdct, int n)
         /*
             for mdct_forward part 0
         */
-        T    = aligned_malloc(sizeof(*T)*(n*2));
+        T    = mem_arena_alloc(arena, sizeof(*T)*(n*2));
         mdct->trig_forward   = T;
         S    = mdct->trig;
         for (i = 0, j = n2-4; i < n8; i += 4, j -= 4) {
@@ -429,7 +429,7 @@ mdct_ctx_init_sse(MDCTContext *mdct, int n)
             for mdct_butterfly_first
         */
         S    = mdct->trig;
-        T    = aligned_malloc(sizeof(*T)*n*2);
+        T    = mem_arena_alloc(arena, sizeof(*T)*n*2);
         mdct->trig_butterfly_first   = T;
         for (i = 0; i < n4; i += 4) {
             __m128  XMM0, XMM1, XMM2, XMM3, XMM4, XMM5;
@@ -464,7 +464,7 @@ mdct_ctx_init_sse(MDCTContext *mdct, int n)
             for mdct_butterfly_generic(trigint=8)
         */
         S    = mdct->trig;
-        T    = aligned_malloc(sizeof(*T)*n2);
+        T    = mem_arena_alloc(arena, sizeof(*T)*n2);
         mdct->trig_butterfly_generic8    = T;
         for (i = 0; i < n; i += 32) {
             __m128  XMM0, XMM1, XMM2, XMM3, XMM4, XMM5;
@@ -492,7 +492,7 @@ mdct_ctx_init_sse(MDCTContext *mdct, int n)
             for mdct_butterfly_generic(trigint=16)
         */
         S    = mdct->trig;
-        T    = aligned_malloc(sizeof(*T)*n4);
+        T    = mem_arena_alloc(arena, sizeof(*T)*n4);
         mdct->trig_butterfly_generic16   = T;
         for (i = 0; i < n; i += 64) {
             __m128  XMM0, XMM1, XMM2, XMM3, XMM4, XMM5;
@@ -523,7 +523,7 @@ mdct_ctx_init_sse(MDCTContext *mdct, int n)
             mdct->trig_butterfly_generic32   = NULL;
         } else {
             S    = mdct->trig;
-            T    = aligned_malloc(sizeof(*T)*n8);
+            T    = mem_arena_alloc(arena, sizeof(*T)*n8);
             mdct->trig_butterfly_generic32   = T;
             for (i = 0; i < n; i += 128) {
                 __m128  XMM0, XMM1, XMM2, XMM3, XMM4, XMM5;
@@ -555,7 +555,7 @@ mdct_ctx_init_sse(MDCTContext *mdct, int n)
             mdct->trig_butterfly_generic64   = NULL;
         } else {
             S    = mdct->trig;
-            T    = aligned_malloc(sizeof(*T)*(n8>>1));
+            T    = mem_arena_alloc(arena, sizeof(*T)*(n8>>1));
             mdct->trig_butterfly_generic64   = T;
             for (i = 0; i < n; i += 256) {
                 __m128  XMM0, XMM1, XMM2, XMM3, XMM4, XMM5;
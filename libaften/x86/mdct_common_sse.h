@@ -51,6 +51,6 @@ void mdct_512_sse(struct A52ThreadContext *tctx, FLOAT *out, FLOAT *in);
 
 void mdct_256_sse(struct A52ThreadContext *tctx, FLOAT *out, FLOAT *in);
 
-void mdct_ctx_init_sse(MDCTContext *mdct, int n);
+void mdct_ctx_init_sse(MDCTContext *mdct, int n, MemArena *arena);
 
 #endif /* MDCT_COMMON_SSE_H */
@@ -355,8 +355,8 @@ mdct_bitreverse_sse(MDCTContext *mdct, FLOAT *x)
 void
 mdct_init_sse(A52Context *ctx)
 {
-    mdct_ctx_init_sse(&ctx->mdct_ctx_512, 512);
-    mdct_ctx_init_sse(&ctx->mdct_ctx_256, 256);
+    mdct_ctx_init_sse(&ctx->mdct_ctx_512, 512, ctx->arena);
+    mdct_ctx_init_sse(&ctx->mdct_ctx_256, 256, ctx->arena);
 
     ctx->mdct_ctx_512.mdct = mdct_512_sse;
     ctx->mdct_ctx_512.mdct_bitreverse = mdct_bitreverse_sse;
@@ -348,8 +348,8 @@ mdct_bitreverse_sse3(MDCTContext *mdct, FLOAT *x)
 void
 mdct_init_sse3(A52Context *ctx)
 {
-    mdct_ctx_init_sse(&ctx->mdct_ctx_512, 512);
-    mdct_ctx_init_sse(&ctx->mdct_ctx_256, 256);
+    mdct_ctx_init_sse(&ctx->mdct_ctx_512, 512, ctx->arena);
+    mdct_ctx_init_sse(&ctx->mdct_ctx_256, 256, ctx->arena);
 
     ctx->mdct_ctx_512.mdct = mdct_512_sse;
     ctx->mdct_ctx_512.mdct_bitreverse = mdct_bitreverse_sse3;
@@ -0,0 +1,40 @@
+/**
+ * Aften: A/52 audio encoder
+ *
+ * x86 mantissa quantization header
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation;
+ * version 2 of the License
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+/**
+ * @file quantize.h
+ * A/52 x86 mantissa quantization header
+ */
+
+#ifndef X86_QUANTIZE_H
+#define X86_QUANTIZE_H
+
+#include "common.h"
+
+#ifdef HAVE_SSE2
+extern void quantize_init_sse2(void);
+extern void quantize_mantissas_ch_sse2(FLOAT *mdct_coef, uint8_t *exp,
+                                       uint8_t *bap, uint16_t *qmant,
+                                       int ncoefs);
+#endif
+
+#endif /* X86_QUANTIZE_H */
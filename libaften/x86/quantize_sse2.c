@@ -0,0 +1,121 @@
+/**
+ * Aften: A/52 audio encoder
+ *
+ * SSE2 mantissa quantization
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation;
+ * version 2 of the License
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+/**
+ * @file quantize_sse2.c
+ * A/52 sse2 optimized mantissa quantization
+ */
+
+#include "a52enc.h"
+#include "x86/simd_support.h"
+
+/** offset which keeps all quantized values positive before truncation */
+#define QUANT_BIAS 65536.0
+
+/**
+ * Quantizer parameters indexed by bap * 25 + exponent:
+ * { scale, bias, lower bound, upper bound }
+ * The quantized value is floor(c * scale + bias) - QUANT_BIAS for the 24-bit
+ * coefficient c.  All products are exact in double precision, which makes
+ * the result identical to the integer quantizer.
+ */
+static ALIGN16(double) quant_tab_sse2[16*25][4];
+
+void
+quantize_init_sse2(void)
+{
+    static const int levels[6] = { 1, 3, 5, 7, 11, 15 };
+    double *t;
+    int b, e, qbits;
+
+    for (b = 0; b < 16; b++) {
+        for (e = 0; e < 25; e++) {
+            t = quant_tab_sse2[b * 25 + e];
+            if (b < 6) {
+                // symmetric: round(c * levels / 2^(25-e)) + (levels >> 1)
+                t[0] = b ? ldexp(levels[b], e - 25) : 0.0;
+                t[1] = QUANT_BIAS + (b ? 0.5 + (levels[b] >> 1) : 0.0);
+                t[2] = QUANT_BIAS;
+                t[3] = QUANT_BIAS + levels[b] - 1;
+            } else {
+                // asymmetric: floor(c / 2^(25-e-qbits))
+                qbits = (b < 14) ? b - 1 : 2 * b - 14;
+                t[0] = ldexp(1.0, e + qbits - 25);
+                t[1] = QUANT_BIAS;
+                t[2] = QUANT_BIAS - (1 << (qbits-1));
+                t[3] = QUANT_BIAS + (1 << (qbits-1)) - 1;
+            }
+        }
+    }
+}
+
+static inline __m128i
+quant_pair(FLOAT *mdct_coef, uint8_t *exp, uint8_t *bap)
+{
+    const __m128d vscale = _mm_set1_pd(16777216.0);
+    const double *t0 = quant_tab_sse2[bap[0] * 25 + exp[0]];
+    const double *t1 = quant_tab_sse2[bap[1] * 25 + exp[1]];
+    __m128d p0 = _mm_load_pd(t0);
+    __m128d p1 = _mm_load_pd(t1);
+    __m128d l0 = _mm_load_pd(t0+2);
+    __m128d l1 = _mm_load_pd(t1+2);
+    __m128d c, x;
+
+#ifdef CONFIG_DOUBLE
+    c = _mm_loadu_pd(mdct_coef);
+#else
+    c = _mm_cvtps_pd(_mm_loadl_pi(_mm_setzero_ps(), (__m64 *)mdct_coef));
+#endif
+    // truncate to the same 24-bit integer as the scalar quantizer
+    c = _mm_cvtepi32_pd(_mm_cvttpd_epi32(_mm_mul_pd(c, vscale)));
+
+    x = _mm_add_pd(_mm_mul_pd(c, _mm_unpacklo_pd(p0, p1)),
+                   _mm_unpackhi_pd(p0, p1));
+    x = _mm_max_pd(x, _mm_unpacklo_pd(l0, l1));
+    x = _mm_min_pd(x, _mm_unpackhi_pd(l0, l1));
+
+    // the biased value is positive, so truncation is the same as floor
+    return _mm_cvttpd_epi32(x);
+}
+
+void
+quantize_mantissas_ch_sse2(FLOAT *mdct_coef, uint8_t *exp, uint8_t *bap,
+                           uint16_t *qmant, int ncoefs)
+{
+    const __m128i vbias = _mm_set1_epi32((int)QUANT_BIAS);
+    const double *t;
+    double x;
+    int i;
+
+    for (i = 0; i < (ncoefs & ~3); i += 4) {
+        __m128i v0 = quant_pair(&mdct_coef[i  ], &exp[i  ], &bap[i  ]);
+        __m128i v1 = quant_pair(&mdct_coef[i+2], &exp[i+2], &bap[i+2]);
+        v0 = _mm_sub_epi32(_mm_unpacklo_epi64(v0, v1), vbias);
+        _mm_storel_epi64((__m128i *)&qmant[i], _mm_packs_epi32(v0, v0));
+    }
+    for (; i < ncoefs; i++) {
+        t = quant_tab_sse2[bap[i] * 25 + exp[i]];
+        x = (int)(mdct_coef[i] * (1 << 24)) * t[0] + t[1];
+        x = CLIP(x, t[2], t[3]);
+        qmant[i] = (int)x - (int)QUANT_BIAS;
+    }
+}
@@ -72,6 +72,11 @@ union __m128iui {
 #undef _mm_lddqu_ps
 #define _mm_lddqu_ps(x) _mm_castsi128_ps(_mm_lddqu_si128((__m128i*)(x)))
 #endif /* USE_SSE3 */
+
+#ifdef USE_PCLMUL
+#include <tmmintrin.h>
+#include <wmmintrin.h>
+#endif /* USE_PCLMUL */
 #endif /* USE_SSE2 */
 
 #ifndef _MM_ALIGN16
@@ -31,6 +31,6 @@
 
 #include "common.h"
 
-extern void apply_a52_window_sse(FLOAT *samples);
+extern void apply_a52_window_sse(FLOAT *out, const FLOAT *in);
 
 #endif /* X86_WINDOW_H */
@@ -27,14 +27,14 @@
 #include <xmmintrin.h>
 
 void
-apply_a52_window_sse(FLOAT *samples)
+apply_a52_window_sse(FLOAT *out, const FLOAT *in)
 {
     int i;
 
     for (i=0; i < 512; i += 4) {
-        __m128 input = _mm_load_ps(samples+i);
+        __m128 input = _mm_load_ps(in+i);
         __m128 window = _mm_load_ps(a52_window+i);
         input = _mm_mul_ps(input, window);
-        _mm_store_ps(samples+i, input);
+        _mm_store_ps(out+i, input);
     }
 }
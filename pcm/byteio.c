@@ -24,13 +24,76 @@
 
 #include "byteio.h"
 
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ * Maps the whole file if it is a regular file.  Pipes and other streams,
+ * and files which cannot be mapped, use the buffered reader instead.
+ */
+static int
+byteio_map(ByteIOContext *ctx, FILE *fp)
+{
+    struct stat st;
+    long pos;
+    void *map;
+
+    if (fstat(fileno(fp), &st) || !S_ISREG(st.st_mode) || st.st_size <= 0)
+        return -1;
+    if ((uint64_t)st.st_size > SIZE_MAX)
+        return -1;
+    pos = ftell(fp);
+    if (pos < 0 || pos > st.st_size)
+        return -1;
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fileno(fp), 0);
+    if (map == MAP_FAILED)
+        return -1;
+    posix_madvise(map, (size_t)st.st_size, POSIX_MADV_SEQUENTIAL);
+
+    ctx->map = map;
+    ctx->map_size = st.st_size;
+    ctx->map_pos = pos;
+    ctx->map_advised = pos & ~(uint64_t)(BYTEIO_MAP_READAHEAD - 1);
+    return 0;
+}
+
+/** keeps at least BYTEIO_MAP_READAHEAD bytes past the read position prefetched */
+static void
+byteio_map_readahead(ByteIOContext *ctx)
+{
+    while (ctx->map_advised < ctx->map_size &&
+           ctx->map_advised < ctx->map_pos + BYTEIO_MAP_READAHEAD) {
+        uint64_t len = MIN(BYTEIO_MAP_READAHEAD, ctx->map_size - ctx->map_advised);
+        posix_madvise((void *)(ctx->map + ctx->map_advised), (size_t)len,
+                      POSIX_MADV_WILLNEED);
+        ctx->map_advised += len;
+    }
+}
+#endif
+
 int
 byteio_init(ByteIOContext *ctx, FILE *fp)
 {
+    ctx->fp = fp;
+    ctx->map = NULL;
+    ctx->map_size = 0;
+    ctx->map_pos = 0;
+    ctx->map_advised = 0;
+    ctx->uring = NULL;
+    ctx->uring_depth = 0;
+#ifdef HAVE_MMAP
+    if (!byteio_map(ctx, fp)) {
+        ctx->buffer = NULL;
+        ctx->index = 0;
+        ctx->size = 0;
+        byteio_map_readahead(ctx);
+        return 0;
+    }
+#endif
     ctx->buffer = calloc(BYTEIO_BUFFER_SIZE, 1);
     if (!ctx->buffer)
         return -1;
-    ctx->fp = fp;
     ctx->index = 0;
     ctx->size = 0;
     byteio_flush(ctx);
@@ -49,6 +112,15 @@ byteio_align(ByteIOContext *ctx)
 int
 byteio_flush(ByteIOContext *ctx)
 {
+    if (ctx->map)
+        return (int)MIN(ctx->map_size - ctx->map_pos, INT32_MAX);
+    if (ctx->uring) {
+        // the buffer is the block the reader just completed
+        int nr = uring_reader_next(ctx->uring, &ctx->buffer);
+        ctx->index = 0;
+        ctx->size = MAX(nr, 0);
+        return ctx->size;
+    }
     ctx->index = 0;
     ctx->size = fread(ctx->buffer, 1, BYTEIO_BUFFER_SIZE, ctx->fp);
     return ctx->size;
@@ -60,6 +132,12 @@ byteio_read(void *ptr, int n, ByteIOContext *ctx)
     uint8_t *ptr8 = ptr;
     int count = 0;
 
+    if (ctx->map) {
+        const uint8_t *src;
+        count = byteio_read_mapped(&src, n, ctx);
+        memcpy(ptr8, src, count);
+        return count;
+    }
     while (n > ctx->size) {
         memcpy(&ptr8[count], &ctx->buffer[ctx->index], ctx->size);
         count += ctx->size;
@@ -81,17 +159,112 @@ byteio_peek(void *ptr, int n, ByteIOContext *ctx)
 {
     int nr;
 
-    if (n > ctx->size)
+    if (ctx->map) {
+        nr = (int)MIN((uint64_t)n, ctx->map_size - ctx->map_pos);
+        memcpy(ptr, ctx->map + ctx->map_pos, nr);
+        return nr;
+    }
+    if (n > ctx->size && !ctx->uring)
         byteio_align(ctx);
     nr = MIN(n, ctx->size);
     memcpy(ptr, &ctx->buffer[ctx->index], nr);
     return nr;
 }
 
+int
+byteio_read_mapped(const uint8_t **ptr, int n, ByteIOContext *ctx)
+{
+    int nr = (int)MIN((uint64_t)MAX(n, 0), ctx->map_size - ctx->map_pos);
+
+    *ptr = ctx->map + ctx->map_pos;
+    ctx->map_pos += nr;
+#ifdef HAVE_MMAP
+    byteio_map_readahead(ctx);
+#endif
+    return nr;
+}
+
+int
+byteio_seek(ByteIOContext *ctx, uint64_t pos)
+{
+#ifdef HAVE_IO_URING
+    if (ctx->uring) {
+        UringReader *u;
+        uint8_t *buf = NULL;
+
+        u = uring_reader_open(fileno(ctx->fp), pos, ctx->uring_depth);
+        if (!u) {
+            // continue from pos with normal reads.  on failure the old
+            // reader is kept, so the context stays usable.
+            buf = calloc(BYTEIO_BUFFER_SIZE, 1);
+            if (!buf || fseeko(ctx->fp, (off_t)pos, SEEK_SET)) {
+                free(buf);
+                return -1;
+            }
+        }
+        uring_reader_close(ctx->uring);
+        ctx->uring = u;
+        ctx->buffer = buf;
+        ctx->index = 0;
+        ctx->size = 0;
+        byteio_flush(ctx);
+        return 0;
+    }
+#endif
+    if (pos > ctx->map_size)
+        return -1;
+    ctx->map_pos = pos;
+#ifdef HAVE_MMAP
+    ctx->map_advised = pos & ~(uint64_t)(BYTEIO_MAP_READAHEAD - 1);
+    byteio_map_readahead(ctx);
+#endif
+    return 0;
+}
+
+int
+byteio_start_uring(ByteIOContext *ctx, uint64_t pos, int depth)
+{
+    UringReader *u;
+
+    if (ctx->uring)
+        return 0;
+    u = uring_reader_open(fileno(ctx->fp), pos, depth);
+    if (!u)
+        return -1;
+
+    // drop the mapping or stdio buffer, the reader owns the buffers now
+#ifdef HAVE_MMAP
+    if (ctx->map)
+        munmap((void *)ctx->map, (size_t)ctx->map_size);
+#endif
+    if (!ctx->map)
+        free(ctx->buffer);
+    ctx->map = NULL;
+    ctx->map_size = 0;
+    ctx->map_pos = 0;
+    ctx->uring = u;
+    ctx->uring_depth = depth;
+    ctx->buffer = NULL;
+    ctx->index = 0;
+    ctx->size = 0;
+    byteio_flush(ctx);
+    return 0;
+}
+
 void
 byteio_close(ByteIOContext *ctx)
 {
     if (ctx) {
+        if (ctx->uring) {
+            uring_reader_close(ctx->uring);
+            ctx->uring = NULL;
+            ctx->buffer = NULL;
+        }
+#ifdef HAVE_MMAP
+        if (ctx->map)
+            munmap((void *)ctx->map, (size_t)ctx->map_size);
+#endif
+        ctx->map = NULL;
         ctx->fp = NULL;
         if (ctx->buffer)
             free(ctx->buffer);
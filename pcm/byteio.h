@@ -26,14 +26,24 @@
 #define BYTEIO_H
 
 #include "common.h"
+#include "uring.h"
 
 #define BYTEIO_BUFFER_SIZE 16384
 
+/** how far ahead of the read position a mapped file is prefetched */
+#define BYTEIO_MAP_READAHEAD (8 << 20)
+
 typedef struct ByteIOContext {
     FILE *fp;
     uint8_t *buffer;
     int index;
     int size;
+    const uint8_t *map;     ///< whole file, if it is memory-mapped
+    uint64_t map_size;
+    uint64_t map_pos;       ///< read position in the mapped file
+    uint64_t map_advised;   ///< end of the range already prefetched
+    UringReader *uring;     ///< asynchronous reader, if started
+    int uring_depth;
 } ByteIOContext;
 
 extern int byteio_init(ByteIOContext *ctx, FILE *fp);
@@ -46,6 +56,25 @@ extern int byteio_read(void *ptr, int n, ByteIOContext *ctx);
 
 extern int byteio_peek(void *ptr, int n, ByteIOContext *ctx);
 
+/**
+ * Reads up to n bytes without copying, for memory-mapped input only.
+ * Sets *ptr to the bytes in the mapping and returns the number read.
+ */
+extern int byteio_read_mapped(const uint8_t **ptr, int n, ByteIOContext *ctx);
+
+/**
+ * Moves the read position to byte offset pos, for memory-mapped or
+ * io_uring input only.
+ */
+extern int byteio_seek(ByteIOContext *ctx, uint64_t pos);
+
+/**
+ * Switches to reading with io_uring from byte offset pos, with depth reads
+ * in flight.  Returns non-zero, and leaves the context as it was, if the
+ * input is not a regular file or io_uring is not available.
+ */
+extern int byteio_start_uring(ByteIOContext *ctx, uint64_t pos, int depth);
+
 extern void byteio_close(ByteIOContext *ctx);
 
 #endif /* BYTEIO_H */
@@ -24,6 +24,10 @@
 
 #include "pcm.h"
 
+#ifdef HAVE_SSE2
+#include "x86/fmt_convert.h"
+#endif
+
 static void
 fmt_convert_u8_to_u8(void *dest_v, void *src_v, int n)
 {
@@ -688,6 +692,138 @@ fmt_convert_double_to_double(void *dest_v, void *src_v, int n)
     memcpy(dest_v, src_v, n * sizeof(double));
 }
 
+#define FMT_CONVERT_PLANAR(name, SRC_TYPE, DEST_TYPE, CONV) \
+static void \
+fmt_convert_planar_##name(void **dest_v, void *src_v, int nch, int n) \
+{ \
+    SRC_TYPE *src = src_v; \
+    SRC_TYPE x; \
+    int ch, i; \
+\
+    for (ch = 0; ch < nch; ch++) { \
+        DEST_TYPE *dest = dest_v[ch]; \
+        for (i = 0; i < n; i++) { \
+            x = src[i*nch+ch]; \
+            dest[i] = CONV; \
+        } \
+    } \
+}
+
+/* same arithmetic as the interleaved versions above */
+FMT_CONVERT_PLANAR(u8_to_float,      uint8_t, float,  (x - 128.0f) / 128.0f)
+FMT_CONVERT_PLANAR(s8_to_float,      int8_t,  float,  x / 128.0f)
+FMT_CONVERT_PLANAR(s16_to_float,     int16_t, float,  x / 32768.0f)
+FMT_CONVERT_PLANAR(s20_to_float,     int32_t, float,  x / 524288.0f)
+FMT_CONVERT_PLANAR(s24_to_float,     int32_t, float,  x / 8388608.0f)
+FMT_CONVERT_PLANAR(s32_to_float,     int32_t, float,  x / 2147483648.0f)
+FMT_CONVERT_PLANAR(float_to_float,   float,   float,  x)
+FMT_CONVERT_PLANAR(double_to_float,  double,  float,  (float)x)
+FMT_CONVERT_PLANAR(u8_to_double,     uint8_t, double, (x - 128.0) / 128.0)
+FMT_CONVERT_PLANAR(s8_to_double,     int8_t,  double, x / 128.0)
+FMT_CONVERT_PLANAR(s16_to_double,    int16_t, double, x / 32768.0)
+FMT_CONVERT_PLANAR(s20_to_double,    int32_t, double, x / 524288.0)
+FMT_CONVERT_PLANAR(s24_to_double,    int32_t, double, x / 8388608.0)
+FMT_CONVERT_PLANAR(s32_to_double,    int32_t, double, x / 2147483648.0)
+FMT_CONVERT_PLANAR(float_to_double,  float,   double, x)
+FMT_CONVERT_PLANAR(double_to_double, double,  double, x)
+
+typedef void (*FmtConvertPlanar)(void **dest_v, void *src_v, int nch, int n);
+
+/** planar conversions to float and double, indexed by source format */
+static const FmtConvertPlanar fmt_convert_planar_to_float[8] = {
+    fmt_convert_planar_u8_to_float,  fmt_convert_planar_s8_to_float,
+    fmt_convert_planar_s16_to_float, fmt_convert_planar_s20_to_float,
+    fmt_convert_planar_s24_to_float, fmt_convert_planar_s32_to_float,
+    fmt_convert_planar_float_to_float, fmt_convert_planar_double_to_float
+};
+static const FmtConvertPlanar fmt_convert_planar_to_double[8] = {
+    fmt_convert_planar_u8_to_double,  fmt_convert_planar_s8_to_double,
+    fmt_convert_planar_s16_to_double, fmt_convert_planar_s20_to_double,
+    fmt_convert_planar_s24_to_double, fmt_convert_planar_s32_to_double,
+    fmt_convert_planar_float_to_double, fmt_convert_planar_double_to_double
+};
+
+/**
+ * Unpacks 3-byte samples in place: src is the last 3/4 of dest, followed by
+ * 1 spare byte, since each sample is loaded with a 4-byte read.
+ */
+static void
+fmt_unpack_24(int32_t *dest, const uint8_t *src, int n, int bit_width, int swap)
+{
+    int unused_bits = 32 - bit_width;
+    int i;
+    int32_t v;
+
+    if (swap) {
+        for (i = 0; i < n; i++) {
+            v = bswap_32(*(uint32_t*)(src + 3*i) << 8);
+            v <<= unused_bits; // clear unused high bits
+            v >>= unused_bits; // sign extend
+            dest[i] = v;
+        }
+    } else {
+        for (i = 0; i < n; i++) {
+            v = *(int32_t*)(src + 3*i);
+            v <<= unused_bits; // clear unused high bits
+            v >>= unused_bits; // sign extend
+            dest[i] = v;
+        }
+    }
+}
+
+#ifdef HAVE_SSE2
+static int
+have_sse2(void)
+{
+#if defined(__x86_64__) || defined(_M_X64)
+    return 1;
+#elif defined(__GNUC__)
+    return __builtin_cpu_supports("sse2");
+#else
+    return 0;
+#endif
+}
+
+/**
+ * Replaces the C conversions to float and double with the SSE2 versions.
+ * Must be called after the C planar conversion is set.
+ */
+static void
+set_fmt_convert_sse2(PcmFile *pf)
+{
+    enum PcmSampleFormat fmt = pf->source_format;
+
+    if (pf->read_format == PCM_SAMPLE_FMT_FLT) {
+        switch (fmt) {
+            case PCM_SAMPLE_FMT_S16: pf->fmt_convert = fmt_convert_s16_to_float_sse2;    break;
+            case PCM_SAMPLE_FMT_S20: pf->fmt_convert = fmt_convert_s20_to_float_sse2;    break;
+            case PCM_SAMPLE_FMT_S24: pf->fmt_convert = fmt_convert_s24_to_float_sse2;    break;
+            case PCM_SAMPLE_FMT_S32: pf->fmt_convert = fmt_convert_s32_to_float_sse2;    break;
+            case PCM_SAMPLE_FMT_DBL: pf->fmt_convert = fmt_convert_double_to_float_sse2; break;
+            default:                                                                     break;
+        }
+        switch (fmt) {
+            case PCM_SAMPLE_FMT_S16: pf->fmt_convert_planar = fmt_convert_planar_s16_to_float_sse2;   break;
+            case PCM_SAMPLE_FMT_S20: pf->fmt_convert_planar = fmt_convert_planar_s20_to_float_sse2;   break;
+            case PCM_SAMPLE_FMT_S24: pf->fmt_convert_planar = fmt_convert_planar_s24_to_float_sse2;   break;
+            case PCM_SAMPLE_FMT_S32: pf->fmt_convert_planar = fmt_convert_planar_s32_to_float_sse2;   break;
+            case PCM_SAMPLE_FMT_FLT: pf->fmt_convert_planar = fmt_convert_planar_float_to_float_sse2; break;
+            default:                                                                                  break;
+        }
+    } else if (pf->read_format == PCM_SAMPLE_FMT_DBL) {
+        switch (fmt) {
+            case PCM_SAMPLE_FMT_S16: pf->fmt_convert = fmt_convert_s16_to_double_sse2;   break;
+            case PCM_SAMPLE_FMT_S20: pf->fmt_convert = fmt_convert_s20_to_double_sse2;   break;
+            case PCM_SAMPLE_FMT_S24: pf->fmt_convert = fmt_convert_s24_to_double_sse2;   break;
+            case PCM_SAMPLE_FMT_S32: pf->fmt_convert = fmt_convert_s32_to_double_sse2;   break;
+            case PCM_SAMPLE_FMT_FLT: pf->fmt_convert = fmt_convert_float_to_double_sse2; break;
+            default:                                                                     break;
+        }
+    }
+    pf->fmt_unpack_24 = fmt_unpack_24_sse2;
+}
+#endif
+
 #define SET_FMT_CONVERT_FROM(srcfmt, pf) \
 { \
     enum PcmSampleFormat rfmt = pf->read_format; \
@@ -729,6 +865,18 @@ pcmfile_set_source_format(PcmFile *pf, enum PcmSampleFormat fmt)
         case PCM_SAMPLE_FMT_DBL: SET_FMT_CONVERT_FROM(double, pf); break;
         default:                                                   break;
     }
+    pf->fmt_unpack_24 = fmt_unpack_24;
+    pf->fmt_convert_planar = NULL;
+    if (fmt >= PCM_SAMPLE_FMT_U8 && fmt <= PCM_SAMPLE_FMT_DBL) {
+        if (pf->read_format == PCM_SAMPLE_FMT_FLT)
+            pf->fmt_convert_planar = fmt_convert_planar_to_float[fmt];
+        else if (pf->read_format == PCM_SAMPLE_FMT_DBL)
+            pf->fmt_convert_planar = fmt_convert_planar_to_double[fmt];
+    }
+#ifdef HAVE_SSE2
+    if (have_sse2())
+        set_fmt_convert_sse2(pf);
+#endif
     if (fmt == PCM_SAMPLE_FMT_FLT || fmt == PCM_SAMPLE_FMT_DBL)
         pf->sample_type = PCM_SAMPLE_TYPE_FLOAT;
     else
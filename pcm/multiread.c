@@ -0,0 +1,179 @@
+/**
+ * Aften: A/52 audio encoder
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file multiread.c
+ * Parallel reading of multi-file input
+ *
+ * Each file after the first has a thread which waits for the job counter
+ * to change, reads its file into its channel buffer and counts itself
+ * done.  The files are independent, so nothing but the job parameters and
+ * the results is shared.
+ */
+
+#include "multiread.h"
+#include "pcm_thread.h"
+
+#ifdef HAVE_POSIX_THREADS
+
+typedef struct PcmMultiReadWorker {
+    PcmMultiRead *mr;
+    PcmThread thread;
+    int index;          ///< file read by this thread
+} PcmMultiReadWorker;
+
+struct PcmMultiRead {
+    PcmContext *pc;
+    PcmMultiReadWorker workers[PCM_MAX_CHANNELS];
+    int num_workers;
+    PcmMutex mutex;
+    PcmCond start_cond; ///< signalled when a job is posted or on stop
+    PcmCond done_cond;  ///< signalled when the last worker finishes a job
+    void **channels;
+    int num_samples;
+    int *nr;
+    unsigned int job;   ///< incremented for each job
+    int pending;        ///< workers still reading the current job
+    int stop;
+};
+
+static void *
+multi_read_thread(void *vworker)
+{
+    PcmMultiReadWorker *w = vworker;
+    PcmMultiRead *mr = w->mr;
+    unsigned int job = 0;
+    int nr;
+
+    pcm_mutex_lock(&mr->mutex);
+    while (1) {
+        while (mr->job == job && !mr->stop)
+            pcm_cond_wait(&mr->start_cond, &mr->mutex);
+        if (mr->stop)
+            break;
+        job = mr->job;
+        pcm_mutex_unlock(&mr->mutex);
+
+        nr = pcmfile_read_samples(&mr->pc->pcm_file[w->index],
+                                  mr->channels[w->index], mr->num_samples);
+
+        pcm_mutex_lock(&mr->mutex);
+        mr->nr[w->index] = nr;
+        if (--mr->pending == 0)
+            pcm_cond_signal(&mr->done_cond);
+    }
+    pcm_mutex_unlock(&mr->mutex);
+    return NULL;
+}
+
+static void
+stop_workers(PcmMultiRead *mr)
+{
+    int i;
+
+    pcm_mutex_lock(&mr->mutex);
+    mr->stop = 1;
+    pcm_cond_broadcast(&mr->start_cond);
+    pcm_mutex_unlock(&mr->mutex);
+    for (i = 0; i < mr->num_workers; i++)
+        pcm_thread_join(mr->workers[i].thread);
+
+    pcm_cond_destroy(&mr->done_cond);
+    pcm_cond_destroy(&mr->start_cond);
+    pcm_mutex_destroy(&mr->mutex);
+    free(mr);
+}
+
+PcmMultiRead *
+pcm_multi_read_create(PcmContext *pc)
+{
+    PcmMultiRead *mr;
+    int i;
+
+    if (pc->num_files < 2)
+        return NULL;
+    mr = calloc(1, sizeof(PcmMultiRead));
+    if (!mr)
+        return NULL;
+    mr->pc = pc;
+    pcm_mutex_init(&mr->mutex);
+    pcm_cond_init(&mr->start_cond);
+    pcm_cond_init(&mr->done_cond);
+
+    for (i = 1; i < pc->num_files; i++) {
+        PcmMultiReadWorker *w = &mr->workers[mr->num_workers];
+        w->mr = mr;
+        w->index = i;
+        if (pcm_thread_create(&w->thread, multi_read_thread, w)) {
+            stop_workers(mr);
+            return NULL;
+        }
+        mr->num_workers++;
+    }
+    return mr;
+}
+
+void
+pcm_multi_read_samples(PcmMultiRead *mr, void **channels, int num_samples,
+                       int *nr)
+{
+    pcm_mutex_lock(&mr->mutex);
+    mr->channels = channels;
+    mr->num_samples = num_samples;
+    mr->nr = nr;
+    mr->pending = mr->num_workers;
+    mr->job++;
+    pcm_cond_broadcast(&mr->start_cond);
+    pcm_mutex_unlock(&mr->mutex);
+
+    nr[0] = pcmfile_read_samples(&mr->pc->pcm_file[0], channels[0], num_samples);
+
+    pcm_mutex_lock(&mr->mutex);
+    while (mr->pending)
+        pcm_cond_wait(&mr->done_cond, &mr->mutex);
+    pcm_mutex_unlock(&mr->mutex);
+}
+
+void
+pcm_multi_read_destroy(PcmMultiRead *mr)
+{
+    if (mr)
+        stop_workers(mr);
+}
+
+#else /* HAVE_POSIX_THREADS */
+
+PcmMultiRead *
+pcm_multi_read_create(UNUSED(PcmContext *pc))
+{
+    return NULL;
+}
+
+void
+pcm_multi_read_samples(UNUSED(PcmMultiRead *mr), UNUSED(void **channels),
+                       UNUSED(int num_samples), UNUSED(int *nr))
+{
+}
+
+void
+pcm_multi_read_destroy(UNUSED(PcmMultiRead *mr))
+{
+}
+
+#endif /* HAVE_POSIX_THREADS */
@@ -0,0 +1,50 @@
+/**
+ * Aften: A/52 audio encoder
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file multiread.h
+ * Parallel reading of multi-file input header
+ */
+
+#ifndef MULTIREAD_H
+#define MULTIREAD_H
+
+#include "pcm.h"
+
+/**
+ * Starts one reader thread for each input file after the first.
+ * Returns NULL if the threads cannot be started, in which case the files
+ * should be read one after another.
+ */
+extern PcmMultiRead *pcm_multi_read_create(PcmContext *pc);
+
+/**
+ * Reads num_samples samples from each file i into channels[i], the first
+ * file on the calling thread and the others on the reader threads, and
+ * waits for all of them.  The result for each file is stored in nr[i].
+ */
+extern void pcm_multi_read_samples(PcmMultiRead *mr, void **channels,
+                                   int num_samples, int *nr);
+
+/**
+ * Stops the reader threads.
+ */
+extern void pcm_multi_read_destroy(PcmMultiRead *mr);
+
+#endif /* MULTIREAD_H */
@@ -23,6 +23,8 @@
  */
 
 #include "pcm.h"
+#include "multiread.h"
+#include "readahead.h"
 
 int
 pcm_init(PcmContext *pc, int num_files, FILE **fp_list, enum PcmSampleFormat read_format,
@@ -81,8 +83,11 @@ void
 pcm_close(PcmContext *pc)
 {
     int i;
+    pcm_read_ahead_destroy(pc->read_ahead);
+    pcm_multi_read_destroy(pc->multi_read);
     for (i = 0; i < pc->num_files; i++)
         pcmfile_close(&pc->pcm_file[i]);
+    free(pc->chan_buf);
     memset(pc, 0, sizeof(PcmContext));
 }
 
@@ -159,35 +164,75 @@ static const uint8_t sample_sizes[8] = { 1, 1, 2, 4, 4, 4, 4, 8 };
             output[k] = input[num_samples * j + i]; \
 }
 
+/**
+ * Reads each file into its own buffer, in parallel if possible, and pads
+ * files which ended early with zeros.
+ */
+static int
+read_files(PcmContext *pc, void **channels, int num_samples)
+{
+    int i, samples_read, ss;
+    int nr[PCM_MAX_CHANNELS];
+
+    if (!pc->multi_read && !pc->multi_read_failed) {
+        pc->multi_read = pcm_multi_read_create(pc);
+        pc->multi_read_failed = !pc->multi_read;
+    }
+    if (pc->multi_read) {
+        pcm_multi_read_samples(pc->multi_read, channels, num_samples, nr);
+    } else {
+        for (i = 0; i < pc->num_files; i++)
+            nr[i] = pcmfile_read_samples(&pc->pcm_file[i], channels[i], num_samples);
+    }
+
+    samples_read = 0;
+    for (i = 0; i < pc->num_files; i++) {
+        if (nr[i] < 0)
+            return -1;
+        samples_read = MAX(samples_read, nr[i]);
+    }
+
+    /* channels which ended early are padded with zeros */
+    ss = sample_sizes[pc->read_format];
+    for (i = 0; i < pc->num_files; i++) {
+        if (nr[i] < samples_read) {
+            memset((uint8_t *)channels[i] + nr[i] * ss, 0,
+                   (samples_read - nr[i]) * ss);
+        }
+    }
+    return samples_read;
+}
+
 int
-pcm_read_samples(PcmContext *pc, void *buffer, int num_samples)
+pcm_read_samples_sync(PcmContext *pc, void *buffer, int num_samples)
 {
     int i;
     int samples_read, chansize;
+    void *channels[PCM_MAX_CHANNELS];
     uint8_t *buf;
-    uint8_t *buf_ptr;
 
     if (pc->num_files == 1)
         return pcmfile_read_samples(&pc->pcm_file[0], buffer, num_samples);
+    num_samples = MIN(num_samples, PCM_MAX_READ);
 
-    /* allocate buffer */
+    /* grow scratch buffer if needed */
     chansize = num_samples * sample_sizes[pc->read_format];
-    buf = calloc(1, chansize * pc->channels);
-    if (!buf)
-        return -1;
-
-    /* read samples from each channel */
-    samples_read = 0;
-    buf_ptr = buf;
-    for (i = 0; i < pc->num_files; i++) {
-        int nr = pcmfile_read_samples(&pc->pcm_file[i], buf_ptr, num_samples);
-        if (nr < 0) {
-            free(buf);
+    if (chansize * pc->channels > pc->chan_buf_size) {
+        free(pc->chan_buf);
+        pc->chan_buf_size = 0;
+        pc->chan_buf = malloc(chansize * pc->channels);
+        if (!pc->chan_buf)
             return -1;
-        }
-        samples_read = MAX(samples_read, nr);
-        buf_ptr += chansize;
+        pc->chan_buf_size = chansize * pc->channels;
     }
+    buf = pc->chan_buf;
+
+    /* read samples from each channel */
+    for (i = 0; i < pc->num_files; i++)
+        channels[i] = buf + i * chansize;
+    samples_read = read_files(pc, channels, num_samples);
+    if (samples_read < 0)
+        return -1;
 
     /* interleave samples to create multichannel */
     switch (pc->read_format) {
@@ -213,6 +258,68 @@ pcm_read_samples(PcmContext *pc, void *buffer, int num_samples)
             break;
     }
 
-    free(buf);
     return samples_read;
 }
+
+int
+pcm_read_samples(PcmContext *pc, void *buffer, int num_samples)
+{
+    if (pc->read_ahead)
+        return pcm_read_ahead_samples(pc->read_ahead, buffer, num_samples);
+    return pcm_read_samples_sync(pc, buffer, num_samples);
+}
+
+int
+pcm_read_samples_planar(PcmContext *pc, void **channels, int num_samples)
+{
+    if (pc->read_ahead) {
+        fprintf(stderr, "planar reads are not possible with read-ahead\n");
+        return -1;
+    }
+    if (pc->num_files == 1)
+        return pcmfile_read_samples_planar(&pc->pcm_file[0], channels, num_samples);
+    return read_files(pc, channels, MIN(num_samples, PCM_MAX_READ));
+}
+
+int
+pcm_set_io_uring(PcmContext *pc, int depth)
+{
+    int i, started = 0;
+
+    for (i = 0; i < pc->num_files; i++) {
+        PcmFile *pf = &pc->pcm_file[i];
+        if (!byteio_start_uring(&pf->io, pf->filepos, depth))
+            started++;
+    }
+    return !started;
+}
+
+int
+pcm_start_read_ahead(PcmContext *pc, int frame_size, int num_frames)
+{
+    int slot_bytes;
+
+    if (pc->read_ahead)
+        return 0;
+    if (frame_size < 1 || frame_size > PCM_MAX_READ || num_frames < 1) {
+        fprintf(stderr, "invalid read-ahead size\n");
+        return -1;
+    }
+    slot_bytes = frame_size * pc->channels * sample_sizes[pc->read_format];
+    pc->read_ahead = pcm_read_ahead_create(pc, frame_size, num_frames, slot_bytes);
+    if (!pc->read_ahead) {
+        fprintf(stderr, "error starting read-ahead\n");
+        return -1;
+    }
+    return 0;
+}
+
+void
+pcm_get_read_ahead_stalls(PcmContext *pc, int *reader_stalls,
+                          int *consumer_stalls)
+{
+    *reader_stalls = 0;
+    *consumer_stalls = 0;
+    if (pc->read_ahead)
+        pcm_read_ahead_stalls(pc->read_ahead, reader_stalls, consumer_stalls);
+}
@@ -27,6 +27,9 @@
 
 #include "pcmfile.h"
 
+typedef struct PcmReadAhead PcmReadAhead;
+typedef struct PcmMultiRead PcmMultiRead;
+
 typedef struct PcmContext {
     PcmFile pcm_file[PCM_MAX_CHANNELS]; ///< source files
     int num_files;                      ///< number of source files
@@ -38,6 +41,13 @@ typedef struct PcmContext {
 
     int read_to_eof;    ///< indicates that data is to be read until EOF
     int read_format;    ///< sample type to convert to when reading
+
+    uint8_t *chan_buf;  ///< per-file scratch buffer for multi-file input
+    int chan_buf_size;  ///< allocated size of chan_buf, only ever grows
+
+    PcmReadAhead *read_ahead;   ///< read-ahead thread, if started
+    PcmMultiRead *multi_read;   ///< reader threads for multi-file input
+    int multi_read_failed;      ///< set if the reader threads could not start
 } PcmContext;
 
 /**
@@ -101,4 +111,40 @@ extern void pcm_print(PcmContext *pc, FILE *st);
  */
 extern int pcm_read_samples(PcmContext *pc, void *buffer, int num_samples);
 
+/**
+ * Reads samples into one buffer per channel, without interleaving them.
+ * channels[i] gets input channel i, so the caller can put the channels in
+ * any order by reordering the pointers.  A multichannel file is converted
+ * and deinterleaved in one pass, which needs the float or double read
+ * format.  Multiple files are read in parallel, and files which end early
+ * are padded with zeros.  Not possible while read-ahead is running.
+ * Returns number of samples read or -1 on error.
+ */
+extern int pcm_read_samples_planar(PcmContext *pc, void **channels,
+                                   int num_samples);
+
+/**
+ * Reads each input file with io_uring, keeping depth reads in flight.
+ * Files which are not regular files keep using normal reads.
+ * Returns non-zero value if no file could use io_uring.
+ */
+extern int pcm_set_io_uring(PcmContext *pc, int depth);
+
+/**
+ * Starts a thread which reads ahead of pcm_read_samples().
+ * The thread keeps up to num_frames frames of frame_size samples read and
+ * converted.  The read parameters must be set before it is started, and no
+ * seeking is possible afterwards.  It is stopped by pcm_close().
+ * Returns non-zero value if an error occurs.
+ */
+extern int pcm_start_read_ahead(PcmContext *pc, int frame_size, int num_frames);
+
+/**
+ * Gets how often the read-ahead thread had to wait for a free frame, and
+ * how often pcm_read_samples() had to wait for the thread.  Few reader
+ * stalls and many consumer stalls mean the input is the bottleneck.
+ */
+extern void pcm_get_read_ahead_stalls(PcmContext *pc, int *reader_stalls,
+                                      int *consumer_stalls);
+
 #endif /* PCM_H */
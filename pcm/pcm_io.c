@@ -36,6 +36,12 @@ pcmfile_seek_set(PcmFile *pf, uint64_t dest)
     FILE *fp = pf->io.fp;
     int slow_seek = !(pf->seekable);
 
+    if (pf->io.map || pf->io.uring) {
+        if (byteio_seek(&pf->io, dest))
+            return -1;
+        pf->filepos = dest;
+        return 0;
+    }
     if (pf->seekable) {
         if (dest <= INT32_MAX) {
             // destination is within first 2GB
@@ -78,19 +84,39 @@ pcmfile_seek_set(PcmFile *pf, uint64_t dest)
     return 0;
 }
 
-int
-pcmfile_read_samples(PcmFile *pf, void *output, int num_samples)
+/**
+ * Converts nr samples to the read format, either interleaved into output
+ * or, if channels is not NULL, into one buffer per channel.
+ */
+static void
+convert_samples(PcmFile *pf, void *output, void **channels, void *src, int nr)
+{
+    if (!channels)
+        pf->fmt_convert(output, src, nr * pf->channels);
+    else if (pf->channels == 1)
+        pf->fmt_convert(channels[0], src, nr);
+    else
+        pf->fmt_convert_planar(channels, src, pf->channels, nr);
+}
+
+static int
+read_samples(PcmFile *pf, void *output, void **channels, int num_samples)
 {
     uint8_t *buffer;
     uint8_t *read_buffer;
     uint32_t bytes_needed, buffer_size;
-    int nr, i, j, bps, nsmp;
+    int nr, i, bps, nsmp;
 
     // check input and limit number of samples
-    if (pf == NULL || pf->io.fp == NULL || output == NULL || pf->fmt_convert == NULL) {
+    if (pf == NULL || pf->io.fp == NULL || (output == NULL && channels == NULL) ||
+            pf->fmt_convert == NULL) {
         fprintf(stderr, "null input to pcmfile_read_samples()\n");
         return -1;
     }
+    if (channels && pf->channels > 1 && pf->fmt_convert_planar == NULL) {
+        fprintf(stderr, "planar reads need float or double read format\n");
+        return -1;
+    }
     if (pf->block_align <= 0) {
         fprintf(stderr, "invalid block_align\n");
         return -1;
@@ -109,22 +135,41 @@ pcmfile_read_samples(PcmFile *pf, void *output, int num_samples)
     if (num_samples <= 0)
         return 0;
 
-    // allocate temporary buffer for raw input data
+    // mapped samples which need no byte swapping or unpacking are converted
+    // straight from the mapping into the output buffer or channels
     bps = pf->block_align / pf->channels;
+    if (pf->io.map && bps != 3 &&
+            (bps == 1 || pf->order != PCM_NON_NATIVE_BYTE_ORDER) &&
+            !((uintptr_t)(pf->io.map + pf->io.map_pos) & (bps - 1))) {
+        const uint8_t *src;
+        nr = byteio_read_mapped(&src, bytes_needed, &pf->io);
+        pf->filepos += nr;
+        nr /= pf->block_align;
+        convert_samples(pf, output, channels, (void *)src, nr);
+        return nr;
+    }
+
+    // grow the scratch buffer for raw input data if needed.  24-bit samples
+    // are unpacked in place to 32-bit, reading 1 byte past the last one.
     buffer_size = (bps != 3) ? bytes_needed : num_samples * sizeof(int32_t) * pf->channels;
-    buffer = calloc(buffer_size + 1, 1);
-    if (!buffer) {
-        fprintf(stderr, "error allocating read buffer\n");
-        return -1;
+    if (buffer_size + 1 > pf->read_buf_size) {
+        free(pf->read_buf);
+        pf->read_buf_size = 0;
+        pf->read_buf = malloc(buffer_size + 1);
+        if (!pf->read_buf) {
+            fprintf(stderr, "error allocating read buffer\n");
+            return -1;
+        }
+        pf->read_buf_size = buffer_size + 1;
     }
+    buffer = pf->read_buf;
+    buffer[buffer_size] = 0;
     read_buffer = buffer + (buffer_size - bytes_needed);
 
-    // read raw audio samples from input stream into temporary buffer
+    // read raw audio samples from input stream into scratch buffer
     nr = byteio_read(read_buffer, bytes_needed, &pf->io);
-    if (nr <= 0) {
-        free(buffer);
+    if (nr <= 0)
         return nr;
-    }
     pf->filepos += nr;
     nr /= pf->block_align;
     nsmp = nr * pf->channels;
@@ -141,26 +186,8 @@ pcmfile_read_samples(PcmFile *pf, void *output, int num_samples)
         }
         break;
     case 3:
-        {
-            int32_t *input = (int32_t*)buffer;
-            int unused_bits = 32 - pf->bit_width;
-            int32_t v;
-            if (pf->order == PCM_NON_NATIVE_BYTE_ORDER) {
-                for (i = 0, j = 0; i < nsmp*bps; i += bps, j++) {
-                    v = bswap_32(*(uint32_t*)(read_buffer + i) << 8);
-                    v <<= unused_bits; // clear unused high bits
-                    v >>= unused_bits; // sign extend
-                    input[j] = v;
-                }
-            } else {
-                for (i = 0, j = 0; i < nsmp*bps; i += bps, j++) {
-                    v = *(int32_t*)(read_buffer + i);
-                    v <<= unused_bits; // clear unused high bits
-                    v >>= unused_bits; // sign extend
-                    input[j] = v;
-                }
-            }
-        }
+        pf->fmt_unpack_24((int32_t *)buffer, read_buffer, nsmp, pf->bit_width,
+                          pf->order == PCM_NON_NATIVE_BYTE_ORDER);
         break;
     case 4:
         if (pf->order == PCM_NON_NATIVE_BYTE_ORDER) {
@@ -177,14 +204,23 @@ pcmfile_read_samples(PcmFile *pf, void *output, int num_samples)
         }
         break;
     }
-    pf->fmt_convert(output, buffer, nsmp);
-
-    // free temporary buffer
-    free(buffer);
+    convert_samples(pf, output, channels, buffer, nr);
 
     return nr;
 }
 
+int
+pcmfile_read_samples(PcmFile *pf, void *output, int num_samples)
+{
+    return read_samples(pf, output, NULL, num_samples);
+}
+
+int
+pcmfile_read_samples_planar(PcmFile *pf, void **channels, int num_samples)
+{
+    return read_samples(pf, NULL, channels, num_samples);
+}
+
 int
 pcmfile_seek_samples(PcmFile *pf, int64_t offset, int whence)
 {
@@ -0,0 +1,66 @@
+/**
+ * Aften: A/52 audio encoder
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file pcm_thread.h
+ * Thread wrappers for the PCM library
+ *
+ * The PCM library only uses threads for optional read helpers, which are
+ * available with POSIX threads.  Thread functions have the pthread
+ * signature, so they are passed to pthread_create() without a cast.
+ */
+
+#ifndef PCM_THREAD_H
+#define PCM_THREAD_H
+
+#include "common.h"
+
+#ifdef HAVE_POSIX_THREADS
+#include <pthread.h>
+
+typedef pthread_t       PcmThread;
+typedef pthread_mutex_t PcmMutex;
+typedef pthread_cond_t  PcmCond;
+
+static inline int
+pcm_thread_create(PcmThread *thread, void *(*func)(void *), void *arg)
+{
+    return pthread_create(thread, NULL, func, arg);
+}
+
+static inline void
+pcm_thread_join(PcmThread thread)
+{
+    pthread_join(thread, NULL);
+}
+
+#define pcm_mutex_init(x)          pthread_mutex_init(x, NULL)
+#define pcm_mutex_destroy(x)       pthread_mutex_destroy(x)
+#define pcm_mutex_lock(x)          pthread_mutex_lock(x)
+#define pcm_mutex_unlock(x)        pthread_mutex_unlock(x)
+
+#define pcm_cond_init(x)           pthread_cond_init(x, NULL)
+#define pcm_cond_destroy(x)        pthread_cond_destroy(x)
+#define pcm_cond_wait(cond, mutex) pthread_cond_wait(cond, mutex)
+#define pcm_cond_signal(x)         pthread_cond_signal(x)
+#define pcm_cond_broadcast(x)      pthread_cond_broadcast(x)
+
+#endif /* HAVE_POSIX_THREADS */
+
+#endif /* PCM_THREAD_H */
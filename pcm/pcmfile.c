@@ -34,6 +34,8 @@ pcmfile_init(PcmFile *pf, FILE *fp, enum PcmSampleFormat read_format,
     }
 
     pf->read_to_eof = 0;
+    pf->read_buf = NULL;
+    pf->read_buf_size = 0;
     pf->file_format = file_format;
     pf->read_format = read_format;
 
@@ -91,6 +93,9 @@ void
 pcmfile_close(PcmFile *pf)
 {
     byteio_close(&pf->io);
+    free(pf->read_buf);
+    pf->read_buf = NULL;
+    pf->read_buf_size = 0;
 }
 
 void
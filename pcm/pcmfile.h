@@ -76,6 +76,13 @@ typedef struct PcmFile {
     /** Format conversion function */
     void (*fmt_convert)(void *dest_v, void *src_v, int n);
 
+    /** Conversion to one buffer per channel, for float and double only */
+    void (*fmt_convert_planar)(void **dest_v, void *src_v, int nch, int n);
+
+    /** Unpacks 3-byte samples to 32-bit, byte swapping them if swap is set */
+    void (*fmt_unpack_24)(int32_t *dest, const uint8_t *src, int n,
+                          int bit_width, int swap);
+
     ByteIOContext io;       ///< input buffer
     uint64_t filepos;       ///< current file position
     int seekable;           ///< indicates if input stream is seekable
@@ -99,6 +106,9 @@ typedef struct PcmFile {
     enum PcmSampleFormat read_format;   ///< sample type to convert to when reading
 
     int internal_fmt;       ///< internal format (e.g. WAVE wFormatTag)
+
+    uint8_t *read_buf;      ///< raw input scratch buffer, only ever grows
+    uint32_t read_buf_size; ///< allocated size of read_buf
 } PcmFile;
 
 
@@ -150,6 +160,16 @@ extern int pcm_get_default_ch_mask(int channels);
  */
 extern int pcmfile_read_samples(PcmFile *pf, void *buffer, int num_samples);
 
+/**
+ * Reads audio samples into one buffer per channel, channels[i] getting
+ * channel i of the file.  The conversion and deinterleaving are done in
+ * one pass, and the caller can reorder the channels by reordering the
+ * pointers.  Multichannel files must use the float or double read format.
+ * Returns number of samples read or -1 on error.
+ */
+extern int pcmfile_read_samples_planar(PcmFile *pf, void **channels,
+                                       int num_samples);
+
 /**
  * Seeks to byte offset within file.
  * Limits the seek position or offset to signed 32-bit.
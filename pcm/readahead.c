@@ -0,0 +1,235 @@
+/**
+ * Aften: A/52 audio encoder
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file readahead.c
+ * PCM read-ahead thread
+ *
+ * A reader thread fills a ring of slots, each holding up to one frame of
+ * samples in the read format.  The consumer copies out of the oldest slot
+ * and frees it once it is used up.  The thread owns the slot after the
+ * newest one and the consumer owns the oldest one, so the samples are
+ * only touched outside of the lock.  A slot with 0 samples marks the end of
+ * the input and one with -1 marks a read error; neither is ever freed.
+ */
+
+#include "readahead.h"
+#include "pcm_thread.h"
+
+#ifdef HAVE_POSIX_THREADS
+
+typedef struct PcmReadAheadSlot {
+    uint8_t *data;
+    int n;              ///< samples in the slot, 0 at end of input, -1 on error
+    int pos;            ///< samples already consumed
+} PcmReadAheadSlot;
+
+struct PcmReadAhead {
+    PcmContext *pc;
+    PcmThread thread;
+    PcmMutex mutex;
+    PcmCond data_cond;  ///< signalled when a slot is filled
+    PcmCond space_cond; ///< signalled when a slot is freed or on stop
+    PcmReadAheadSlot *slots;
+    uint8_t *buffer;
+    int num_slots;
+    int frame_size;
+    int sample_bytes;   ///< bytes of one sample for all channels
+    int head;           ///< oldest filled slot
+    int count;          ///< number of filled slots
+    int stop;
+    int reader_stalls;  ///< times the thread waited for a free slot
+    int consumer_stalls;///< times the consumer waited for a filled slot
+};
+
+static void *
+read_ahead_thread(void *vra)
+{
+    PcmReadAhead *ra = vra;
+    PcmReadAheadSlot *slot;
+    int nr;
+
+    while (1) {
+        pcm_mutex_lock(&ra->mutex);
+        if (ra->count == ra->num_slots && !ra->stop) {
+            ra->reader_stalls++;
+            while (ra->count == ra->num_slots && !ra->stop)
+                pcm_cond_wait(&ra->space_cond, &ra->mutex);
+        }
+        if (ra->stop) {
+            pcm_mutex_unlock(&ra->mutex);
+            break;
+        }
+        slot = &ra->slots[(ra->head + ra->count) % ra->num_slots];
+        pcm_mutex_unlock(&ra->mutex);
+
+        nr = pcm_read_samples_sync(ra->pc, slot->data, ra->frame_size);
+
+        pcm_mutex_lock(&ra->mutex);
+        slot->n = nr;
+        slot->pos = 0;
+        ra->count++;
+        pcm_cond_signal(&ra->data_cond);
+        pcm_mutex_unlock(&ra->mutex);
+        if (nr <= 0)
+            break;
+    }
+    return NULL;
+}
+
+PcmReadAhead *
+pcm_read_ahead_create(PcmContext *pc, int frame_size, int num_slots,
+                      int slot_bytes)
+{
+    PcmReadAhead *ra;
+    int i;
+
+    ra = calloc(1, sizeof(PcmReadAhead));
+    if (!ra)
+        return NULL;
+    ra->slots = calloc(num_slots, sizeof(PcmReadAheadSlot));
+    ra->buffer = malloc((size_t)num_slots * slot_bytes);
+    if (!ra->slots || !ra->buffer) {
+        free(ra->slots);
+        free(ra->buffer);
+        free(ra);
+        return NULL;
+    }
+    for (i = 0; i < num_slots; i++)
+        ra->slots[i].data = ra->buffer + (size_t)i * slot_bytes;
+    ra->pc = pc;
+    ra->num_slots = num_slots;
+    ra->frame_size = frame_size;
+    ra->sample_bytes = slot_bytes / frame_size;
+
+    pcm_mutex_init(&ra->mutex);
+    pcm_cond_init(&ra->data_cond);
+    pcm_cond_init(&ra->space_cond);
+    if (pcm_thread_create(&ra->thread, read_ahead_thread, ra)) {
+        pcm_cond_destroy(&ra->space_cond);
+        pcm_cond_destroy(&ra->data_cond);
+        pcm_mutex_destroy(&ra->mutex);
+        free(ra->slots);
+        free(ra->buffer);
+        free(ra);
+        return NULL;
+    }
+    return ra;
+}
+
+int
+pcm_read_ahead_samples(PcmReadAhead *ra, void *buffer, int num_samples)
+{
+    uint8_t *out = buffer;
+    PcmReadAheadSlot *slot;
+    int got = 0;
+    int nc;
+
+    while (got < num_samples) {
+        pcm_mutex_lock(&ra->mutex);
+        if (!ra->count) {
+            ra->consumer_stalls++;
+            while (!ra->count)
+                pcm_cond_wait(&ra->data_cond, &ra->mutex);
+        }
+        slot = &ra->slots[ra->head];
+        pcm_mutex_unlock(&ra->mutex);
+
+        // the end and error slots stay in place for any later calls
+        if (slot->n <= 0)
+            return got ? got : slot->n;
+
+        nc = MIN(num_samples - got, slot->n - slot->pos);
+        memcpy(out + got * ra->sample_bytes,
+               slot->data + slot->pos * ra->sample_bytes,
+               nc * ra->sample_bytes);
+        got += nc;
+        slot->pos += nc;
+
+        if (slot->pos == slot->n) {
+            pcm_mutex_lock(&ra->mutex);
+            ra->head = (ra->head + 1) % ra->num_slots;
+            ra->count--;
+            pcm_cond_signal(&ra->space_cond);
+            pcm_mutex_unlock(&ra->mutex);
+        }
+    }
+    return got;
+}
+
+void
+pcm_read_ahead_destroy(PcmReadAhead *ra)
+{
+    if (!ra)
+        return;
+    pcm_mutex_lock(&ra->mutex);
+    ra->stop = 1;
+    pcm_cond_signal(&ra->space_cond);
+    pcm_mutex_unlock(&ra->mutex);
+    pcm_thread_join(ra->thread);
+
+    pcm_cond_destroy(&ra->space_cond);
+    pcm_cond_destroy(&ra->data_cond);
+    pcm_mutex_destroy(&ra->mutex);
+    free(ra->slots);
+    free(ra->buffer);
+    free(ra);
+}
+
+void
+pcm_read_ahead_stalls(PcmReadAhead *ra, int *reader_stalls,
+                      int *consumer_stalls)
+{
+    pcm_mutex_lock(&ra->mutex);
+    *reader_stalls = ra->reader_stalls;
+    *consumer_stalls = ra->consumer_stalls;
+    pcm_mutex_unlock(&ra->mutex);
+}
+
+#else /* HAVE_POSIX_THREADS */
+
+PcmReadAhead *
+pcm_read_ahead_create(UNUSED(PcmContext *pc), UNUSED(int frame_size),
+                      UNUSED(int num_slots), UNUSED(int slot_bytes))
+{
+    fprintf(stderr, "read-ahead is only supported with POSIX threads\n");
+    return NULL;
+}
+
+int
+pcm_read_ahead_samples(UNUSED(PcmReadAhead *ra), UNUSED(void *buffer),
+                       UNUSED(int num_samples))
+{
+    return -1;
+}
+
+void
+pcm_read_ahead_destroy(UNUSED(PcmReadAhead *ra))
+{
+}
+
+void
+pcm_read_ahead_stalls(UNUSED(PcmReadAhead *ra), int *reader_stalls,
+                      int *consumer_stalls)
+{
+    *reader_stalls = 0;
+    *consumer_stalls = 0;
+}
+
+#endif /* HAVE_POSIX_THREADS */
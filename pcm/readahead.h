@@ -0,0 +1,56 @@
+/**
+ * Aften: A/52 audio encoder
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file readahead.h
+ * PCM read-ahead thread header
+ */
+
+#ifndef READAHEAD_H
+#define READAHEAD_H
+
+#include "pcm.h"
+
+/**
+ * Reads samples directly from the input files, bypassing read-ahead.
+ */
+extern int pcm_read_samples_sync(PcmContext *pc, void *buffer, int num_samples);
+
+/**
+ * Starts a thread which reads slots of frame_size samples into a ring of
+ * num_slots slots.  slot_bytes is the size of one slot in the read format.
+ */
+extern PcmReadAhead *pcm_read_ahead_create(PcmContext *pc, int frame_size,
+                                           int num_slots, int slot_bytes);
+
+/**
+ * Reads samples from the ring, waiting for the thread when it is empty.
+ */
+extern int pcm_read_ahead_samples(PcmReadAhead *ra, void *buffer,
+                                  int num_samples);
+
+/**
+ * Stops the thread and frees the ring.
+ */
+extern void pcm_read_ahead_destroy(PcmReadAhead *ra);
+
+extern void pcm_read_ahead_stalls(PcmReadAhead *ra, int *reader_stalls,
+                                  int *consumer_stalls);
+
+#endif /* READAHEAD_H */
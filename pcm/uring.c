@@ -0,0 +1,338 @@
+/**
+ * Aften: A/52 audio encoder
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file uring.c
+ * Asynchronous file reader using Linux io_uring
+ *
+ * The file is read in consecutive blocks by a ring of slots, each with one
+ * read in flight until it is consumed.  Slots are consumed in order, and a
+ * consumed slot is resubmitted for the block after the last one requested.
+ * The io_uring system calls are used directly, so no extra library is
+ * needed.
+ */
+
+// syscall() is hidden by _XOPEN_SOURCE alone
+#define _DEFAULT_SOURCE
+
+#include "uring.h"
+
+#ifdef HAVE_IO_URING
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+
+enum SlotState {
+    SLOT_IDLE = 0,      ///< past the end of the file, nothing requested
+    SLOT_PENDING,
+    SLOT_DONE
+};
+
+typedef struct UringSlot {
+    uint8_t *data;
+    struct iovec iov;
+    uint64_t offset;
+    int len;            ///< bytes requested
+    int res;            ///< completion result
+    int state;
+} UringSlot;
+
+struct UringReader {
+    int ring_fd;
+    int fd;
+    uint64_t end;       ///< file size
+    uint64_t next_off;  ///< offset of the next block to request
+    int depth;
+    int head;           ///< next slot to consume
+    int cur;            ///< slot handed out by the last call, or -1
+    UringSlot slots[URING_MAX_DEPTH];
+    uint8_t *buffer;
+
+    void *sq_ptr, *cq_ptr;
+    size_t sq_size, cq_size;
+    struct io_uring_sqe *sqes;
+    size_t sqes_size;
+    unsigned *sq_tail, *sq_mask, *sq_array;
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_cqe *cqes;
+};
+
+static int
+sys_io_uring_setup(unsigned entries, struct io_uring_params *p)
+{
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int
+sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete,
+                   unsigned flags)
+{
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete,
+                        flags, NULL, 0);
+}
+
+/** queues a read of the next block into a slot, without submitting it */
+static void
+queue_read(UringReader *u, int i)
+{
+    UringSlot *slot = &u->slots[i];
+    struct io_uring_sqe *sqe;
+    unsigned tail, idx;
+
+    if (u->next_off >= u->end) {
+        slot->state = SLOT_IDLE;
+        return;
+    }
+    slot->offset = u->next_off;
+    slot->len = (int)MIN((uint64_t)URING_BLOCK_SIZE, u->end - u->next_off);
+    slot->iov.iov_base = slot->data;
+    slot->iov.iov_len = slot->len;
+    slot->state = SLOT_PENDING;
+    u->next_off += slot->len;
+
+    tail = *u->sq_tail;
+    idx = tail & *u->sq_mask;
+    sqe = &u->sqes[idx];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_READV;
+    sqe->fd = u->fd;
+    sqe->off = slot->offset;
+    sqe->addr = (uintptr_t)&slot->iov;
+    sqe->len = 1;
+    sqe->user_data = i;
+    u->sq_array[idx] = idx;
+    __atomic_store_n(u->sq_tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+static int
+submit(UringReader *u, unsigned n, unsigned min_complete)
+{
+    unsigned flags = min_complete ? IORING_ENTER_GETEVENTS : 0;
+    int ret;
+
+    do {
+        ret = sys_io_uring_enter(u->ring_fd, n, min_complete, flags);
+    } while (ret < 0 && errno == EINTR);
+    return ret < 0 ? -1 : 0;
+}
+
+static void
+reap_completions(UringReader *u)
+{
+    unsigned head = *u->cq_head;
+
+    while (head != __atomic_load_n(u->cq_tail, __ATOMIC_ACQUIRE)) {
+        struct io_uring_cqe *cqe = &u->cqes[head & *u->cq_mask];
+        UringSlot *slot = &u->slots[cqe->user_data];
+        slot->res = cqe->res;
+        slot->state = SLOT_DONE;
+        head++;
+    }
+    __atomic_store_n(u->cq_head, head, __ATOMIC_RELEASE);
+}
+
+static void
+unmap_rings(UringReader *u)
+{
+    if (u->sqes)
+        munmap(u->sqes, u->sqes_size);
+    if (u->cq_ptr && u->cq_ptr != u->sq_ptr)
+        munmap(u->cq_ptr, u->cq_size);
+    if (u->sq_ptr)
+        munmap(u->sq_ptr, u->sq_size);
+    close(u->ring_fd);
+}
+
+UringReader *
+uring_reader_open(int fd, uint64_t pos, int depth)
+{
+    UringReader *u;
+    struct io_uring_params p;
+    struct stat st;
+    uint8_t *sq, *cq;
+    int i, queued;
+
+    if (fstat(fd, &st) || !S_ISREG(st.st_mode))
+        return NULL;
+    depth = CLIP(depth, 1, URING_MAX_DEPTH);
+
+    u = calloc(1, sizeof(UringReader));
+    if (!u)
+        return NULL;
+    memset(&p, 0, sizeof(p));
+    u->ring_fd = sys_io_uring_setup(depth, &p);
+    if (u->ring_fd < 0) {
+        free(u);
+        return NULL;
+    }
+
+    u->sq_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    u->cq_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP)
+        u->sq_size = u->cq_size = MAX(u->sq_size, u->cq_size);
+    u->sq_ptr = mmap(NULL, u->sq_size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, u->ring_fd, IORING_OFF_SQ_RING);
+    if (u->sq_ptr == MAP_FAILED) {
+        u->sq_ptr = NULL;
+        goto fail;
+    }
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        u->cq_ptr = u->sq_ptr;
+    } else {
+        u->cq_ptr = mmap(NULL, u->cq_size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, u->ring_fd,
+                         IORING_OFF_CQ_RING);
+        if (u->cq_ptr == MAP_FAILED) {
+            u->cq_ptr = NULL;
+            goto fail;
+        }
+    }
+    u->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+    u->sqes = mmap(NULL, u->sqes_size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, u->ring_fd, IORING_OFF_SQES);
+    if (u->sqes == MAP_FAILED) {
+        u->sqes = NULL;
+        goto fail;
+    }
+    sq = u->sq_ptr;
+    cq = u->cq_ptr;
+    u->sq_tail  = (unsigned *)(sq + p.sq_off.tail);
+    u->sq_mask  = (unsigned *)(sq + p.sq_off.ring_mask);
+    u->sq_array = (unsigned *)(sq + p.sq_off.array);
+    u->cq_head  = (unsigned *)(cq + p.cq_off.head);
+    u->cq_tail  = (unsigned *)(cq + p.cq_off.tail);
+    u->cq_mask  = (unsigned *)(cq + p.cq_off.ring_mask);
+    u->cqes     = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+
+    u->buffer = malloc((size_t)depth * URING_BLOCK_SIZE);
+    if (!u->buffer)
+        goto fail;
+    for (i = 0; i < depth; i++)
+        u->slots[i].data = u->buffer + (size_t)i * URING_BLOCK_SIZE;
+    u->fd = fd;
+    u->end = st.st_size;
+    u->next_off = pos;
+    u->depth = depth;
+    u->head = 0;
+    u->cur = -1;
+
+    queued = 0;
+    for (i = 0; i < depth; i++) {
+        queue_read(u, i);
+        queued += (u->slots[i].state == SLOT_PENDING);
+    }
+    if (queued && submit(u, queued, 0)) {
+        // nothing was queued to the kernel, so the buffer is not in use
+        free(u->buffer);
+        goto fail;
+    }
+    return u;
+
+fail:
+    unmap_rings(u);
+    free(u);
+    return NULL;
+}
+
+int
+uring_reader_next(UringReader *u, uint8_t **data)
+{
+    UringSlot *slot;
+    int got;
+
+    if (u->cur >= 0) {
+        queue_read(u, u->cur);
+        if (u->slots[u->cur].state == SLOT_PENDING && submit(u, 1, 0))
+            return -1;
+        u->head = (u->head + 1) % u->depth;
+        u->cur = -1;
+    }
+
+    slot = &u->slots[u->head];
+    if (slot->state == SLOT_IDLE)
+        return 0;
+    while (slot->state == SLOT_PENDING) {
+        reap_completions(u);
+        if (slot->state == SLOT_PENDING && submit(u, 0, 1))
+            return -1;
+    }
+
+    // finish failed or short reads synchronously
+    got = MAX(slot->res, 0);
+    while (got < slot->len) {
+        ssize_t nr = pread(u->fd, slot->data + got, slot->len - got,
+                           (off_t)(slot->offset + got));
+        if (nr < 0 && errno == EINTR)
+            continue;
+        if (nr < 0 && !got)
+            return -1;
+        if (nr <= 0)
+            break;
+        got += (int)nr;
+    }
+
+    *data = slot->data;
+    u->cur = u->head;
+    return got;
+}
+
+void
+uring_reader_close(UringReader *u)
+{
+    int i, pending;
+
+    if (!u)
+        return;
+    // the kernel may still write into the buffer until every read completes
+    do {
+        reap_completions(u);
+        pending = 0;
+        for (i = 0; i < u->depth; i++)
+            pending += (u->slots[i].state == SLOT_PENDING);
+    } while (pending && !submit(u, 0, 1));
+
+    unmap_rings(u);
+    free(u->buffer);
+    free(u);
+}
+
+#else /* HAVE_IO_URING */
+
+UringReader *
+uring_reader_open(UNUSED(int fd), UNUSED(uint64_t pos), UNUSED(int depth))
+{
+    return NULL;
+}
+
+int
+uring_reader_next(UNUSED(UringReader *u), UNUSED(uint8_t **data))
+{
+    return -1;
+}
+
+void
+uring_reader_close(UNUSED(UringReader *u))
+{
+}
+
+#endif /* HAVE_IO_URING */
@@ -0,0 +1,59 @@
+/**
+ * Aften: A/52 audio encoder
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file uring.h
+ * Asynchronous file reader using Linux io_uring, header
+ */
+
+#ifndef URING_H
+#define URING_H
+
+#include "common.h"
+
+/** size of each read kept in flight */
+#define URING_BLOCK_SIZE (512 * 1024)
+
+/** maximum number of reads in flight per file */
+#define URING_MAX_DEPTH 64
+
+typedef struct UringReader UringReader;
+
+/**
+ * Starts reading a regular file from byte offset pos, with depth reads of
+ * URING_BLOCK_SIZE in flight.  Returns NULL if the file is not a regular
+ * file or io_uring is not available, in which case the caller should keep
+ * using normal reads.
+ */
+extern UringReader *uring_reader_open(int fd, uint64_t pos, int depth);
+
+/**
+ * Gets the next block of the file, in order.  The block returned by the
+ * previous call is handed back to the kernel for a new read.
+ * Returns the number of bytes in *data, 0 at the end of the file, or -1 on
+ * a read error.
+ */
+extern int uring_reader_next(UringReader *u, uint8_t **data);
+
+/**
+ * Waits for all reads in flight and frees the reader.
+ */
+extern void uring_reader_close(UringReader *u);
+
+#endif /* URING_H */
@@ -0,0 +1,67 @@
+/**
+ * Aften: A/52 audio encoder
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file fmt_convert.h
+ * x86 PCM sample format conversion header
+ */
+
+#ifndef PCM_X86_FMT_CONVERT_H
+#define PCM_X86_FMT_CONVERT_H
+
+#include "common.h"
+
+#ifdef HAVE_SSE2
+extern void fmt_convert_s16_to_float_sse2(void *dest_v, void *src_v, int n);
+extern void fmt_convert_s20_to_float_sse2(void *dest_v, void *src_v, int n);
+extern void fmt_convert_s24_to_float_sse2(void *dest_v, void *src_v, int n);
+extern void fmt_convert_s32_to_float_sse2(void *dest_v, void *src_v, int n);
+extern void fmt_convert_double_to_float_sse2(void *dest_v, void *src_v, int n);
+
+extern void fmt_convert_s16_to_double_sse2(void *dest_v, void *src_v, int n);
+extern void fmt_convert_s20_to_double_sse2(void *dest_v, void *src_v, int n);
+extern void fmt_convert_s24_to_double_sse2(void *dest_v, void *src_v, int n);
+extern void fmt_convert_s32_to_double_sse2(void *dest_v, void *src_v, int n);
+extern void fmt_convert_float_to_double_sse2(void *dest_v, void *src_v, int n);
+
+/**
+ * Conversions of interleaved samples to one float buffer per channel.
+ * 2 and 6 channels are vectorized, other channel counts use plain C.
+ */
+extern void fmt_convert_planar_s16_to_float_sse2(void **dest_v, void *src_v,
+                                                 int nch, int n);
+extern void fmt_convert_planar_s20_to_float_sse2(void **dest_v, void *src_v,
+                                                 int nch, int n);
+extern void fmt_convert_planar_s24_to_float_sse2(void **dest_v, void *src_v,
+                                                 int nch, int n);
+extern void fmt_convert_planar_s32_to_float_sse2(void **dest_v, void *src_v,
+                                                 int nch, int n);
+extern void fmt_convert_planar_float_to_float_sse2(void **dest_v, void *src_v,
+                                                   int nch, int n);
+
+/**
+ * Unpacks n 3-byte samples from src to sign-extended 32-bit samples in
+ * dest, byte swapping them if swap is set.  Same contract as the C version
+ * in convert.c, including working in place.
+ */
+extern void fmt_unpack_24_sse2(int32_t *dest, const uint8_t *src, int n,
+                               int bit_width, int swap);
+#endif
+
+#endif /* PCM_X86_FMT_CONVERT_H */
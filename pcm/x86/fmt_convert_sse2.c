@@ -0,0 +1,289 @@
+/**
+ * Aften: A/52 audio encoder
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file fmt_convert_sse2.c
+ * SSE2 PCM sample format conversion
+ *
+ * Only the conversions to float and double are done here, since those are
+ * the read formats used by the encoder.  All integer scales are powers of
+ * two, so multiplying by the reciprocal gives the same result as the
+ * division in the C versions.  Buffers need not be aligned.
+ */
+
+#include "deinterleave_sse2.h"
+#include "fmt_convert.h"
+
+/** converts 8 16-bit samples to 2 vectors of 32-bit samples */
+static inline void
+unpack_s16(const int16_t *src, __m128i *lo, __m128i *hi)
+{
+    __m128i x = _mm_loadu_si128((const __m128i *)src);
+    *lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+    *hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+}
+
+void
+fmt_convert_s16_to_float_sse2(void *dest_v, void *src_v, int n)
+{
+    float *dest = dest_v;
+    int16_t *src = src_v;
+    __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+    __m128i lo, hi;
+    int i;
+
+    for (i = 0; i + 8 <= n; i += 8) {
+        unpack_s16(src+i, &lo, &hi);
+        _mm_storeu_ps(dest+i,   _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(dest+i+4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+    for (; i < n; i++)
+        dest[i] = src[i] / 32768.0f;
+}
+
+static inline void
+convert_s32_to_float(float *dest, const int32_t *src, int n, float scale)
+{
+    __m128 vscale = _mm_set1_ps(scale);
+    __m128i x0, x1;
+    int i;
+
+    for (i = 0; i + 8 <= n; i += 8) {
+        x0 = _mm_loadu_si128((const __m128i *)(src+i));
+        x1 = _mm_loadu_si128((const __m128i *)(src+i+4));
+        _mm_storeu_ps(dest+i,   _mm_mul_ps(_mm_cvtepi32_ps(x0), vscale));
+        _mm_storeu_ps(dest+i+4, _mm_mul_ps(_mm_cvtepi32_ps(x1), vscale));
+    }
+    for (; i < n; i++)
+        dest[i] = src[i] * scale;
+}
+
+void
+fmt_convert_s20_to_float_sse2(void *dest_v, void *src_v, int n)
+{
+    convert_s32_to_float(dest_v, src_v, n, 1.0f / 524288.0f);
+}
+
+void
+fmt_convert_s24_to_float_sse2(void *dest_v, void *src_v, int n)
+{
+    convert_s32_to_float(dest_v, src_v, n, 1.0f / 8388608.0f);
+}
+
+void
+fmt_convert_s32_to_float_sse2(void *dest_v, void *src_v, int n)
+{
+    convert_s32_to_float(dest_v, src_v, n, 1.0f / 2147483648.0f);
+}
+
+void
+fmt_convert_double_to_float_sse2(void *dest_v, void *src_v, int n)
+{
+    float *dest = dest_v;
+    double *src = src_v;
+    __m128 lo, hi;
+    int i;
+
+    for (i = 0; i + 4 <= n; i += 4) {
+        lo = _mm_cvtpd_ps(_mm_loadu_pd(src+i));
+        hi = _mm_cvtpd_ps(_mm_loadu_pd(src+i+2));
+        _mm_storeu_ps(dest+i, _mm_movelh_ps(lo, hi));
+    }
+    for (; i < n; i++)
+        dest[i] = (float)src[i];
+}
+
+/** converts 4 32-bit samples to double and stores them */
+static inline void
+store_s32_as_double(double *dest, __m128i x, __m128d scale)
+{
+    __m128d lo = _mm_cvtepi32_pd(x);
+    __m128d hi = _mm_cvtepi32_pd(_mm_srli_si128(x, 8));
+    _mm_storeu_pd(dest,   _mm_mul_pd(lo, scale));
+    _mm_storeu_pd(dest+2, _mm_mul_pd(hi, scale));
+}
+
+void
+fmt_convert_s16_to_double_sse2(void *dest_v, void *src_v, int n)
+{
+    double *dest = dest_v;
+    int16_t *src = src_v;
+    __m128d scale = _mm_set1_pd(1.0 / 32768.0);
+    __m128i lo, hi;
+    int i;
+
+    for (i = 0; i + 8 <= n; i += 8) {
+        unpack_s16(src+i, &lo, &hi);
+        store_s32_as_double(dest+i,   lo, scale);
+        store_s32_as_double(dest+i+4, hi, scale);
+    }
+    for (; i < n; i++)
+        dest[i] = src[i] / 32768.0;
+}
+
+static inline void
+convert_s32_to_double(double *dest, const int32_t *src, int n, double scale)
+{
+    __m128d vscale = _mm_set1_pd(scale);
+    int i;
+
+    for (i = 0; i + 4 <= n; i += 4)
+        store_s32_as_double(dest+i, _mm_loadu_si128((const __m128i *)(src+i)),
+                            vscale);
+    for (; i < n; i++)
+        dest[i] = src[i] * scale;
+}
+
+void
+fmt_convert_s20_to_double_sse2(void *dest_v, void *src_v, int n)
+{
+    convert_s32_to_double(dest_v, src_v, n, 1.0 / 524288.0);
+}
+
+void
+fmt_convert_s24_to_double_sse2(void *dest_v, void *src_v, int n)
+{
+    convert_s32_to_double(dest_v, src_v, n, 1.0 / 8388608.0);
+}
+
+void
+fmt_convert_s32_to_double_sse2(void *dest_v, void *src_v, int n)
+{
+    convert_s32_to_double(dest_v, src_v, n, 1.0 / 2147483648.0);
+}
+
+void
+fmt_convert_float_to_double_sse2(void *dest_v, void *src_v, int n)
+{
+    double *dest = dest_v;
+    float *src = src_v;
+    __m128 x;
+    int i;
+
+    for (i = 0; i + 4 <= n; i += 4) {
+        x = _mm_loadu_ps(src+i);
+        _mm_storeu_pd(dest+i,   _mm_cvtps_pd(x));
+        _mm_storeu_pd(dest+i+2, _mm_cvtps_pd(_mm_movehl_ps(x, x)));
+    }
+    for (; i < n; i++)
+        dest[i] = src[i];
+}
+
+/* 2 and 6 channels get their own copy of the loop, with nch constant */
+
+void
+fmt_convert_planar_s16_to_float_sse2(void **dest_v, void *src_v, int nch, int n)
+{
+    const float scale = 1.0f / 32768.0f;
+    float **dest = (float **)dest_v;
+
+    switch (nch) {
+    case 2:  deinterleave_s16_sse2(dest, src_v, 2,   n, scale); break;
+    case 6:  deinterleave_s16_sse2(dest, src_v, 6,   n, scale); break;
+    default: deinterleave_s16_sse2(dest, src_v, nch, n, scale); break;
+    }
+}
+
+static inline void
+planar_s32_nch(void **dest_v, void *src_v, int nch, int n, float scale)
+{
+    float **dest = (float **)dest_v;
+
+    switch (nch) {
+    case 2:  deinterleave_s32_sse2(dest, src_v, 2,   n, scale); break;
+    case 6:  deinterleave_s32_sse2(dest, src_v, 6,   n, scale); break;
+    default: deinterleave_s32_sse2(dest, src_v, nch, n, scale); break;
+    }
+}
+
+void
+fmt_convert_planar_s20_to_float_sse2(void **dest_v, void *src_v, int nch, int n)
+{
+    planar_s32_nch(dest_v, src_v, nch, n, 1.0f / 524288.0f);
+}
+
+void
+fmt_convert_planar_s24_to_float_sse2(void **dest_v, void *src_v, int nch, int n)
+{
+    planar_s32_nch(dest_v, src_v, nch, n, 1.0f / 8388608.0f);
+}
+
+void
+fmt_convert_planar_s32_to_float_sse2(void **dest_v, void *src_v, int nch, int n)
+{
+    planar_s32_nch(dest_v, src_v, nch, n, 1.0f / 2147483648.0f);
+}
+
+void
+fmt_convert_planar_float_to_float_sse2(void **dest_v, void *src_v, int nch, int n)
+{
+    float **dest = (float **)dest_v;
+
+    switch (nch) {
+    case 2:  deinterleave_float_sse2(dest, src_v, 2,   n); break;
+    case 6:  deinterleave_float_sse2(dest, src_v, 6,   n); break;
+    default: deinterleave_float_sse2(dest, src_v, nch, n); break;
+    }
+}
+
+/**
+ * Each group of 4 samples is read with one 16-byte load, which reaches 1
+ * byte into the 6th sample.  The loop stops while a 5th sample remains, so
+ * the load never goes past the end of the data plus the 1 spare byte the
+ * C version also reads.  The load comes before the store, and the store
+ * (4 bytes per sample) stays behind the next load (3 bytes per sample)
+ * when unpacking in place.
+ */
+void
+fmt_unpack_24_sse2(int32_t *dest, const uint8_t *src, int n, int bit_width,
+                   int swap)
+{
+    __m128i shift = _mm_cvtsi32_si128(32 - bit_width);
+    __m128i mask_lo = _mm_set1_epi32(0xFF);
+    __m128i mask_mid = _mm_set1_epi32(0xFF00);
+    __m128i x, a, b;
+    int i;
+    int32_t v;
+
+    for (i = 0; i + 4 < n; i += 4) {
+        x = _mm_loadu_si128((const __m128i *)(src + 3*i));
+        // move sample k from bytes 3k..3k+2 to the low bytes of lane k
+        a = _mm_unpacklo_epi32(x, _mm_srli_si128(x, 3));
+        b = _mm_unpacklo_epi32(_mm_srli_si128(x, 6), _mm_srli_si128(x, 9));
+        x = _mm_unpacklo_epi64(a, b);
+        if (swap) {
+            x = _mm_or_si128(_mm_or_si128(
+                    _mm_slli_epi32(_mm_and_si128(x, mask_lo), 16),
+                    _mm_and_si128(x, mask_mid)),
+                    _mm_and_si128(_mm_srli_epi32(x, 16), mask_lo));
+        }
+        // clear unused high bits and sign extend
+        x = _mm_sra_epi32(_mm_sll_epi32(x, shift), shift);
+        _mm_storeu_si128((__m128i *)(dest + i), x);
+    }
+    for (; i < n; i++) {
+        const uint8_t *p = src + 3*i;
+        if (swap)
+            v = (p[0] << 16) | (p[1] << 8) | p[2];
+        else
+            v = p[0] | (p[1] << 8) | (p[2] << 16);
+        v = (int32_t)((uint32_t)v << (32 - bit_width));
+        dest[i] = v >> (32 - bit_width);
+    }
+}
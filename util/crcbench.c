@@ -0,0 +1,215 @@
+/**
+ * Aften: A/52 audio encoder
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file crcbench.c
+ * Console CRC-16 Benchmark Utility
+ *
+ * Checks that the bytewise, slice-by-8 and PCLMULQDQ versions of
+ * calc_crc16() and crc16_zero() give the same results, then times each of
+ * them on frame-sized buffers the way the encoder uses them.
+ */
+
+#include "common.h"
+
+#include <time.h>
+
+#include "aften-types.h"
+#include "cpu_caps.h"
+#include "crc.h"
+
+#define NUM_IMPLS 3
+
+static const char *impl_names[NUM_IMPLS] = {
+    "bytewise", "slice-by-8", "pclmul"
+};
+
+static uint32_t rand_state = 1;
+
+static uint32_t
+next_rand(void)
+{
+    rand_state = rand_state * 1664525 + 1013904223;
+    return rand_state >> 8;
+}
+
+/**
+ * Compares all available implementations on every length up to the
+ * maximum frame size, each with its own random data.
+ * @return number of mismatches
+ */
+static int
+check_impls(uint8_t *buf, int *avail)
+{
+    uint16_t crc[NUM_IMPLS], zero[NUM_IMPLS];
+    int len, i, k, errors;
+
+    memset(crc, 0, sizeof(crc));
+    memset(zero, 0, sizeof(zero));
+    errors = 0;
+    for (len = 0; len <= A52_MAX_CODED_FRAME_SIZE; len++) {
+        for (i = 0; i < len; i++)
+            buf[i] = next_rand();
+        for (k = 0; k < NUM_IMPLS; k++) {
+            if (!avail[k])
+                continue;
+            crc_select(k);
+            crc[k] = calc_crc16(buf, len);
+            zero[k] = crc16_zero(crc[k], MAX(len, 2));
+        }
+        for (k = 1; k < NUM_IMPLS; k++) {
+            if (!avail[k])
+                continue;
+            if (crc[k] != crc[0] || zero[k] != zero[0]) {
+                if (errors < 10) {
+                    fprintf(stderr, "%s mismatch at %d bytes: "
+                            "crc %04X != %04X, zero %04X != %04X\n",
+                            impl_names[k], len, crc[k], crc[0], zero[k],
+                            zero[0]);
+                }
+                errors++;
+            }
+        }
+    }
+    return errors;
+}
+
+/**
+ * Times one implementation doing what output_frame_end() does for each
+ * frame: a crc over 5/8 of the frame and one over the rest, each followed
+ * by crc16_zero().
+ * @return frames per second
+ */
+static double
+time_impl(uint8_t *buf, int frame_size, int iterations)
+{
+    clock_t t0, t1;
+    uint32_t sum;
+    int i, words, f58;
+    double secs;
+
+    words = frame_size >> 1;
+    f58 = ((words >> 1) + (words >> 3)) << 1;
+    sum = 0;
+    t0 = clock();
+    for (i = 0; i < iterations; i++) {
+        sum += crc16_zero(calc_crc16(&buf[2], f58 - 2), f58);
+        sum += crc16_zero(calc_crc16(&buf[f58], frame_size - f58 - 2),
+                          frame_size - f58);
+        buf[2] = sum;
+    }
+    t1 = clock();
+    secs = (double)(t1 - t0) / CLOCKS_PER_SEC;
+    return secs > 0 ? iterations / secs : 0.0;
+}
+
+static void
+print_intro(FILE *stream)
+{
+    fprintf(stream, "\nCrcBench: utility program to compare A/52 CRC-16 versions.\n"
+                    "(c) 2026 agent <agent@local>\n\n");
+}
+
+static void
+print_usage(FILE *stream)
+{
+    fprintf(stream, "usage: crcbench [<iterations>]\n"
+                    "    default is 100000 iterations per frame size.\n"
+                    "\n");
+}
+
+int
+main(int argc, char **argv)
+{
+    static const int frame_sizes[3] = { 256, 1792, A52_MAX_CODED_FRAME_SIZE };
+    uint8_t *buf;
+    int avail[NUM_IMPLS];
+    double fps[NUM_IMPLS];
+    int iterations, errors, i, k;
+
+    if (argc > 2) {
+        print_intro(stderr);
+        print_usage(stderr);
+        exit(1);
+    }
+    print_intro(stdout);
+    if (argc == 2 && !strncmp(argv[1], "-h", 3)) {
+        print_usage(stdout);
+        return 0;
+    }
+    iterations = 100000;
+    if (argc == 2) {
+        iterations = atoi(argv[1]);
+        if (iterations <= 0) {
+            fprintf(stderr, "invalid number of iterations\n");
+            exit(1);
+        }
+    }
+
+    buf = malloc(A52_MAX_CODED_FRAME_SIZE);
+    if (!buf) {
+        fprintf(stderr, "error allocating buffer\n");
+        exit(1);
+    }
+    cpu_caps_detect();
+    crc_init();
+    for (k = 0; k < NUM_IMPLS; k++) {
+        avail[k] = !crc_select(k);
+        if (!avail[k])
+            fprintf(stdout, "%s is not available\n", impl_names[k]);
+    }
+
+    errors = check_impls(buf, avail);
+    if (errors) {
+        fprintf(stderr, "%d mismatches\n\n", errors);
+        free(buf);
+        exit(1);
+    }
+    fprintf(stdout, "all versions match for 0 to %d bytes\n\n",
+            A52_MAX_CODED_FRAME_SIZE);
+
+    fprintf(stdout, "frames per second:\n");
+    fprintf(stdout, "%10s", "bytes");
+    for (k = 0; k < NUM_IMPLS; k++) {
+        if (avail[k])
+            fprintf(stdout, " %12s", impl_names[k]);
+    }
+    fprintf(stdout, "   speedup\n");
+    for (i = 0; i < 3; i++) {
+        for (k = 0; k < A52_MAX_CODED_FRAME_SIZE; k++)
+            buf[k] = next_rand();
+        for (k = 0; k < NUM_IMPLS; k++) {
+            if (!avail[k])
+                continue;
+            crc_select(k);
+            fps[k] = time_impl(buf, frame_sizes[i], iterations);
+        }
+        fprintf(stdout, "%10d", frame_sizes[i]);
+        for (k = 0; k < NUM_IMPLS; k++) {
+            if (avail[k])
+                fprintf(stdout, " %12.0f", fps[k]);
+        }
+        fprintf(stdout, "   %6.1fx\n",
+                fps[0] > 0 ? fps[avail[2] ? 2 : 1] / fps[0] : 0.0);
+    }
+    fprintf(stdout, "\n");
+
+    free(buf);
+    return 0;
+}
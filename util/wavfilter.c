@@ -120,6 +120,7 @@ main(int argc, char **argv)
     int nr;
     int i;
     FilterContext f[6];
+    MemArena *arena;
     int ftype=0;
     enum PcmSampleFormat read_format;
 
@@ -160,6 +161,11 @@ main(int argc, char **argv)
     }
     output_wav_header(ofp, &pf);
 
+    arena = mem_arena_create(0, 0);
+    if (!arena) {
+        fprintf(stderr, "error allocating memory\n");
+        exit(1);
+    }
     for (i = 0; i < pf.channels; i++) {
         int cutoff;
         f[i].type = (enum FilterType)ftype;
@@ -167,7 +173,7 @@ main(int argc, char **argv)
         cutoff = atoi(argv[2]);
         f[i].cutoff = (FLOAT)cutoff;
         f[i].samplerate = (FLOAT)pf.sample_rate;
-        if (filter_init(&f[i], FILTER_ID_BUTTERWORTH_II)) {
+        if (filter_init(&f[i], FILTER_ID_BUTTERWORTH_II, arena)) {
             fprintf(stderr, "error initializing filter\n");
             exit(1);
         }
@@ -183,8 +189,7 @@ main(int argc, char **argv)
         nr = pcmfile_read_samples(&pf, buf, frame_size);
     }
 
-    for (i = 0; i < pf.channels; i++)
-        filter_close(&f[i]);
+    mem_arena_destroy(arena);
 
     free(buf);
     pcmfile_close(&pf);